@@ -0,0 +1,220 @@
+/**
+ * Benchmark suite of the logger: throughput and latency percentiles of log calls for different log levels, message
+ * shapes, sinks and numbers of threads.
+ *
+ * Built twice, as simple_logger_bench (synchronous) and simple_logger_bench_async (asynchronous mode).
+ * Usage: simple_logger_bench [messages per thread] [max threads]
+ */
+
+#include <simple_logger.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+using namespace simple_logger;
+
+namespace {
+
+using BenchClock = std::chrono::steady_clock;
+
+/**
+ * Sink discarding everything, to measure the logger without any I/O.
+ */
+class NullSink : public Sink {
+public:
+    void write(std::string_view, bool) override {
+    }
+};
+
+enum class Shape {
+    Literal,
+    Ints,
+    Strings,
+    Doubles,
+};
+
+enum class Output {
+    Null,
+    File,
+    Ofstream,
+};
+
+struct Result {
+    double nsPerMessage;
+    double messagesPerSecond;
+    std::int64_t p50;
+    std::int64_t p99;
+    std::int64_t p999;
+};
+
+const char *shapeName(Shape shape) {
+    switch (shape) {
+        case Shape::Literal:
+            return "literal";
+        case Shape::Ints:
+            return "ints";
+        case Shape::Strings:
+            return "strings";
+        case Shape::Doubles:
+            return "doubles";
+    }
+    return "";
+}
+
+const char *outputName(Output output) {
+    switch (output) {
+        case Output::Null:
+            return "null";
+        case Output::File:
+            return "file";
+        case Output::Ofstream:
+            return "ofstream";
+    }
+    return "";
+}
+
+/**
+ * Log messages from a number of threads, measuring the latency of each call and the overall throughput (including
+ * writing of all messages in asynchronous mode).
+ */
+template<typename F>
+Result measure(int threadCount, int messagesPerThread, F &&logMessage) {
+    std::vector<std::vector<std::int64_t>> latencies(threadCount);
+    std::vector<std::thread> threads;
+    auto start = BenchClock::now();
+    for (int t = 0; t < threadCount; ++t) {
+        threads.emplace_back([&latencies, &logMessage, t, messagesPerThread] {
+            auto &samples = latencies[t];
+            samples.reserve(messagesPerThread);
+            for (int i = 0; i < messagesPerThread; ++i) {
+                auto before = BenchClock::now();
+                logMessage(i);
+                samples.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        BenchClock::now() - before).count());
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    flush();
+    std::chrono::duration<double, std::nano> elapsed{BenchClock::now() - start};
+
+    std::vector<std::int64_t> all;
+    all.reserve(static_cast<std::size_t>(threadCount) * messagesPerThread);
+    for (const auto &samples : latencies) {
+        all.insert(all.end(), samples.begin(), samples.end());
+    }
+    auto percentile = [&all](double fraction) {
+        auto nth = all.begin() + static_cast<std::ptrdiff_t>(fraction * static_cast<double>(all.size() - 1));
+        std::nth_element(all.begin(), nth, all.end());
+        return *nth;
+    };
+    double nsPerMessage{elapsed.count() / static_cast<double>(all.size())};
+    return {nsPerMessage, 1e9 / nsPerMessage, percentile(0.5), percentile(0.99), percentile(0.999)};
+}
+
+template<LogLevel Level, Shape S>
+void logShape(std::ostream *stream, int i) {
+    static const std::string text{"some string argument"};
+    auto log = [stream] {
+        return stream != nullptr ? Log<Level>(*stream) : Log<Level>();
+    };
+    if constexpr (S == Shape::Literal) {
+        log() << "literal message without any arguments";
+    } else if constexpr (S == Shape::Ints) {
+        log() << "ints " << i << ' ' << i * 7 << ' ' << -i;
+    } else if constexpr (S == Shape::Strings) {
+        log() << "strings " << text << ' ' << std::string_view(text).substr(5);
+    } else {
+        log() << "doubles " << i * 0.1 << ' ' << 1.0 / (i + 1);
+    }
+}
+
+/**
+ * Call run(level, shape) with the log level and message shape as std::integral_constant, so that they are selected
+ * once instead of for each measured message.
+ */
+template<typename F>
+Result withShape(LogLevel level, Shape shape, F &&run) {
+    auto withLevel = [&run, level]<Shape S>(std::integral_constant<Shape, S> shapeConstant) {
+        // Error is always active, Trace is inactive unless Config::logLevel is changed
+        if (level == LogLevel::Error) {
+            return run(std::integral_constant<LogLevel, LogLevel::Error>{}, shapeConstant);
+        } else {
+            return run(std::integral_constant<LogLevel, LogLevel::Trace>{}, shapeConstant);
+        }
+    };
+    switch (shape) {
+        case Shape::Literal:
+            return withLevel(std::integral_constant<Shape, Shape::Literal>{});
+        case Shape::Ints:
+            return withLevel(std::integral_constant<Shape, Shape::Ints>{});
+        case Shape::Strings:
+            return withLevel(std::integral_constant<Shape, Shape::Strings>{});
+        case Shape::Doubles:
+            break;
+    }
+    return withLevel(std::integral_constant<Shape, Shape::Doubles>{});
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    int messagesPerThread{argc > 1 ? std::atoi(argv[1]) : 100000};
+    int maxThreads{argc > 2 ? std::atoi(argv[2])
+            : std::max(1, static_cast<int>(std::thread::hardware_concurrency()))};
+
+    const char *fileName{"simple_logger_bench.log"};
+    const char *streamFileName{"simple_logger_bench_stream.log"};
+    Config::logFileName = fileName;
+    std::shared_ptr<Sink> nullSink{std::make_shared<NullSink>()};
+    std::ofstream stream{streamFileName};
+
+    std::printf("mode: %s\n", Config::asynchronous ? "asynchronous" : "synchronous");
+    std::printf("%-9s %-9s %-9s %7s %11s %13s %8s %8s %8s\n", "level", "shape", "sink", "threads", "ns/msg",
+            "msg/s", "p50 ns", "p99 ns", "p999 ns");
+    for (std::string_view level : {"active", "inactive"}) {
+        for (Shape shape : {Shape::Literal, Shape::Ints, Shape::Strings, Shape::Doubles}) {
+            for (Output output : {Output::Null, Output::File, Output::Ofstream}) {
+                if (output == Output::Null) {
+                    Sinks::set(LogLevel::Error, {nullSink});
+                    Sinks::set(LogLevel::Trace, {nullSink});
+                } else {
+                    Sinks::set(LogLevel::Error, {Sinks::logFile()});
+                    Sinks::set(LogLevel::Trace, {Sinks::logFile()});
+                }
+                std::ostream *target{output == Output::Ofstream ? &stream : nullptr};
+                for (int threads = 1; threads <= maxThreads; threads *= 2) {
+                    LogLevel logLevel{level == "active" ? LogLevel::Error : LogLevel::Trace};
+                    Result result{withShape(logLevel, shape, [&](auto levelConstant, auto shapeConstant) {
+                        return measure(threads, messagesPerThread, [target](int i) {
+                            logShape<decltype(levelConstant)::value, decltype(shapeConstant)::value>(target, i);
+                        });
+                    })};
+                    std::printf("%-9.*s %-9s %-9s %7d %11.1f %13.0f %8lld %8lld %8lld\n",
+                            static_cast<int>(level.size()), level.data(), shapeName(shape), outputName(output),
+                            threads, result.nsPerMessage, result.messagesPerSecond, static_cast<long long>(result.p50),
+                            static_cast<long long>(result.p99), static_cast<long long>(result.p999));
+                    std::fflush(stdout);
+                    if (threads < maxThreads && threads * 2 > maxThreads) {
+                        threads = maxThreads / 2;
+                    }
+                }
+            }
+        }
+    }
+    shutdown();
+    stream.close();
+    std::remove(fileName);
+    std::remove(streamFileName);
+}
@@ -0,0 +1,39 @@
+# Prints the code size of each log call site in code_size.cpp, i.e. of its function's hot and cold parts
+# (run by the simple_logger_code_size target, meaningful in optimized builds).
+#
+# Expects NM, SYNC_OBJECT and ASYNC_OBJECT variables.
+
+set(sites "")
+foreach(mode SYNC ASYNC)
+    execute_process(COMMAND ${NM} --print-size --demangle ${${mode}_OBJECT}
+            OUTPUT_VARIABLE symbols RESULT_VARIABLE result)
+    if(NOT result EQUAL 0)
+        message(FATAL_ERROR "${NM} failed on ${${mode}_OBJECT}")
+    endif()
+    string(REPLACE "\n" ";" lines "${symbols}")
+    foreach(line IN LISTS lines)
+        if(line MATCHES "^[0-9a-f]+ ([0-9a-f]+) [tT] (site[A-Za-z]+)\\(")
+            set(site ${CMAKE_MATCH_2})
+            math(EXPR size "0x${CMAKE_MATCH_1}")
+            if(NOT DEFINED ${mode}_${site})
+                set(${mode}_${site} 0)
+                list(APPEND sites ${site})
+            endif()
+            math(EXPR ${mode}_${site} "${${mode}_${site}} + ${size}")
+        endif()
+    endforeach()
+endforeach()
+
+list(REMOVE_DUPLICATES sites)
+message("bytes per call site    sync   async")
+foreach(site IN LISTS sites)
+    string(LENGTH ${site} length)
+    math(EXPR padding "20 - ${length}")
+    string(REPEAT " " ${padding} spaces)
+    foreach(mode SYNC ASYNC)
+        string(LENGTH "${${mode}_${site}}" length)
+        math(EXPR padding "8 - ${length}")
+        string(REPEAT " " ${padding} ${mode}_spaces)
+    endforeach()
+    message("${site}${spaces}${SYNC_spaces}${SYNC_${site}}${ASYNC_spaces}${ASYNC_${site}}")
+endforeach()
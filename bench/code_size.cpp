@@ -0,0 +1,33 @@
+/**
+ * Typical log call sites, each in its own function, for measuring how much code a call site adds to the function
+ * using it (see code_size.cmake, run by the simple_logger_code_size target).
+ *
+ * Compiled (but not linked) twice, for synchronous and asynchronous mode.
+ */
+
+#include <simple_logger.h>
+
+#include <ostream>
+#include <string_view>
+
+using namespace simple_logger;
+
+[[gnu::noinline]] void siteLiteral() {
+    LOG_INFO << "connection closed";
+}
+
+[[gnu::noinline]] void siteMixed(int count, std::string_view name) {
+    LOG_INFO << count << " items in " << name;
+}
+
+[[gnu::noinline]] void siteDouble(double value) {
+    LOG_INFO << "value " << value;
+}
+
+[[gnu::noinline]] void siteStream(std::ostream &stream, int value) {
+    Log<LogLevel::Info>(stream) << "value " << value;
+}
+
+[[gnu::noinline]] void siteInactive(int value) {
+    LOG_TRACE << "value " << value;
+}
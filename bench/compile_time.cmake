@@ -0,0 +1,33 @@
+# Compares the compile time of compile_time.cpp using simple_logger_core.h and using the original single header
+# (original_simple_logger.h), failing if the core header is slower (run by the simple_logger_compile_time target).
+#
+# Expects CXX, INCLUDE_DIR and SOURCE variables. Each variant is compiled (syntax only) several times, alternately,
+# and the fastest run counts.
+
+if(CMAKE_VERSION VERSION_LESS 3.23)
+    message(FATAL_ERROR "Measuring compile time needs CMake 3.23 or newer")
+endif()
+
+set(runs 5)
+set(CORE_flags -DSIMPLE_LOGGER_COMPILED)
+set(ORIGINAL_flags -DSIMPLE_LOGGER_COMPILE_TIME_BASELINE)
+foreach(run RANGE 1 ${runs})
+    foreach(variant CORE ORIGINAL)
+        string(TIMESTAMP start "%s%f")
+        execute_process(COMMAND ${CXX} -std=c++20 -fsyntax-only -I${INCLUDE_DIR} ${${variant}_flags} ${SOURCE}
+                RESULT_VARIABLE result)
+        string(TIMESTAMP end "%s%f")
+        if(NOT result EQUAL 0)
+            message(FATAL_ERROR "${CXX} failed on ${SOURCE} (${variant})")
+        endif()
+        math(EXPR milliseconds "(${end} - ${start}) / 1000")
+        if(NOT DEFINED ${variant}_time OR milliseconds LESS ${variant}_time)
+            set(${variant}_time ${milliseconds})
+        endif()
+    endforeach()
+endforeach()
+
+message("compile time: simple_logger_core.h ${CORE_time} ms, original header ${ORIGINAL_time} ms")
+if(NOT CORE_time LESS ORIGINAL_time)
+    message(FATAL_ERROR "simple_logger_core.h compiles slower than the original header")
+endif()
@@ -0,0 +1,23 @@
+/**
+ * Typical log call sites compiled against simple_logger_core.h, or against the original single header if
+ * SIMPLE_LOGGER_COMPILE_TIME_BASELINE is defined (see compile_time.cmake, run by the simple_logger_compile_time
+ * target).
+ */
+
+#ifdef SIMPLE_LOGGER_COMPILE_TIME_BASELINE
+#include "original_simple_logger.h"
+#else
+#include <simple_logger_core.h>
+#endif
+
+void logConnection(int fd, const char *peer) {
+    LOG_INFO << "accepted connection " << fd << " from " << peer;
+}
+
+void logProgress(double fraction, unsigned long bytes) {
+    LOG_DEBUG << "progress " << fraction << " (" << bytes << " bytes)";
+}
+
+void logFailure(int error) {
+    LOG_ERROR << "request failed with error " << error;
+}
@@ -0,0 +1,70 @@
+/**
+ * Scaling of synchronous logging from 1 to 64 threads writing into the same stream.
+ *
+ * Each message is formatted privately and copied into the stream under the stream's lock, so the lock is only held
+ * for the copy (and flush). Usage: simple_logger_sync_scaling [messages per thread]
+ */
+
+#include <simple_logger.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace simple_logger;
+
+namespace {
+
+/**
+ * Stream buffer discarding everything, to measure the logger without any I/O.
+ */
+class NullBuffer : public std::streambuf {
+protected:
+    int_type overflow(int_type character) override {
+        return traits_type::not_eof(character);
+    }
+
+    std::streamsize xsputn(const char *, std::streamsize count) override {
+        return count;
+    }
+};
+
+double measure(std::ostream &stream, int threadCount, int messagesPerThread) {
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now();
+    for (int t = 0; t < threadCount; ++t) {
+        threads.emplace_back([&stream, t, messagesPerThread] {
+            for (int i = 0; i < messagesPerThread; ++i) {
+                Log<LogLevel::Error>(stream) << "thread " << t << " message " << i << " value " << 0.5 * i;
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    std::chrono::duration<double, std::nano> elapsed{std::chrono::steady_clock::now() - start};
+    return elapsed.count() / (static_cast<double>(threadCount) * messagesPerThread);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    int messagesPerThread{argc > 1 ? std::atoi(argv[1]) : 20000};
+
+    NullBuffer nullBuffer;
+    std::ostream nullStream{&nullBuffer};
+    std::ofstream devNull{"/dev/null"};
+
+    std::printf("%8s %20s %20s %20s %20s\n", "threads", "null ns/msg", "null msg/s", "/dev/null ns/msg",
+            "/dev/null msg/s");
+    for (int threads = 1; threads <= 64; threads *= 2) {
+        double nullNs{measure(nullStream, threads, messagesPerThread)};
+        double fileNs{measure(devNull, threads, messagesPerThread)};
+        std::printf("%8d %20.1f %20.0f %20.1f %20.0f\n", threads, nullNs, 1e9 / nullNs, fileNs, 1e9 / fileNs);
+    }
+}
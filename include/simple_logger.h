@@ -24,256 +24,2612 @@
 
 #pragma once
 
-#include <cstdint>
-#include <iostream>
-#include <fstream>
-#include <iomanip>
-#include <source_location>
+#include "simple_logger_core.h"
+#include "simple_logger_coroutine.h"
+#include "simple_logger_format.h"
+#include "simple_logger_stats.h"
+
 #include <chrono>
-#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
 
 namespace simple_logger {
 
-enum class LogLevel : uint8_t {
-    Trace = 0,
-    Debug,
-    Info,
-    Warning,
-    Error,
+/**
+ * Output of log messages.
+ */
+class Sink {
+public:
+    virtual ~Sink() = default;
+
+    /**
+     * Write one or more whole log messages (each terminated by a newline), optionally flushing the output.
+     *
+     * Can be called by multiple threads concurrently, implementations must make sure messages don't interleave.
+     */
+    virtual void write(std::string_view text, bool flush) = 0;
+
+    virtual void flush() {
+    }
 };
 
-inline constexpr const char *logLevelToString(LogLevel level) {
-    switch (level) {
-        case LogLevel::Trace: return "Trace";
-        case LogLevel::Debug: return "Debug";
-        case LogLevel::Info: return "Info";
-        case LogLevel::Warning: return "Warning";
-        case LogLevel::Error: return "Error";
-        default: return "Unknown";
+/**
+ * Sink writing into a stream owned by someone else (e.g. std::cout).
+ */
+class StreamSink : public Sink {
+public:
+    explicit StreamSink(std::ostream &stream) : m_stream(stream) {
+    }
+
+    void write(std::string_view text, bool flush) override {
+        detail::writeLocked(m_stream, text, flush);
+    }
+
+    void flush() override {
+        detail::flushLocked(m_stream);
+    }
+
+    std::ostream &stream() const {
+        return m_stream;
     }
-}
+
+private:
+    std::ostream &m_stream;
+};
 
 /**
- * Configuration class of the logger.
+ * Runtime configuration of sinks used by log messages without explicit stream, initialized from Config.
  *
- * Feel free to edit the constant values directly in this file, other values can be adjusted anywhere in code as needed.
+ * Changes are thread-safe and logging threads never wait for them, nor do changes wait for logging threads: a replaced
+ * sink may still receive messages being written while it's replaced, it's destroyed once no thread uses it anymore.
  */
-class Config {
+class Sinks {
 public:
     /**
-     * Determines verbosity of the logger.
-     *
-     * Only logs with equal or higher level will be printed by the logger, lower-level logs will be ignored.
-     * The first value (if NDEBUG is set) is for RELEASE builds, the second value is for DEBUG builds.
-     * (NDEBUG is automatically set if the appropriate compiler flag is used, otherwise feel free to use any other macro
-     * available)
+     * Replace the sinks of a log level.
      */
-#ifdef NDEBUG
-    static constexpr LogLevel logLevel{LogLevel::Info};
-#else
-    static constexpr LogLevel logLevel{LogLevel::Debug};
-#endif
+    SIMPLE_LOGGER_API static void set(LogLevel level, std::vector<std::shared_ptr<Sink>> sinks);
 
     /**
-     * If true, each log contains function signature, otherwise only file and line are logged.
+     * Add a sink to a log level (messages are then written to all of its sinks).
      */
-    static constexpr bool includeFunctionSignature{false};
+    SIMPLE_LOGGER_API static void add(LogLevel level, std::shared_ptr<Sink> sink);
 
     /**
-     * If you need precise time information adjusted for timezone, use this variable to add/subtract hours.
+     * Sink of the current log file (see Config::logFileName), e.g. to add it to other log levels.
      */
-    static constexpr long timezoneAdjustment{0};
+    SIMPLE_LOGGER_API static std::shared_ptr<Sink> logFile();
 
     /**
-     * If logging to file is used, set this variable to the desired log file path/name.
+     * Write messages going to the log file into a different file (opened for appending), the old one is closed once
+     * no thread writes into it anymore.
      */
-    static inline std::string logFileName{std::string(logLevelToString(logLevel)) + ".log"};
+    SIMPLE_LOGGER_API static void setLogFile(std::string fileName);
 
     /**
-     * Determines the default stream for each log level where output will be printed.
-     *
-     * This function is used by convenience macros defined later.
-     * Adjust the return values for individual levels to use desired output streams.
-     *
-     * NOTE: A function is used instead of static variables to correctly open log files if they're used.
+     * Close and reopen the log file for appending (e.g. after it was moved by log rotation).
      */
-    template<LogLevel Level>
-    static std::ostream &getDefaultStream() {
-        if constexpr (Level == LogLevel::Debug) {
-            return getLogFile();
-        } else if constexpr (Level == LogLevel::Info) {
-            return getLogFile();
-        } else if constexpr (Level == LogLevel::Warning) {
-            return getLogFile();
-        } else if constexpr (Level == LogLevel::Error) {
-            return getLogFile();
-        } else {
-            return std::cout;
-        }
-    }
-
-    static std::ofstream &getLogFile() {
-        if (!logFile.is_open()) {
-            logFile = std::ofstream(logFileName);
-        }
-        return logFile;
-    }
-
-private:
-    static inline std::ofstream logFile;
+    SIMPLE_LOGGER_API static void reopenLogFile();
 };
 
+
 /**
- * Log class intended to be used as a temporary object for each log message.
- *
- * You can either use this class directly, or use the convenience macros defined later for less verbose usage.
- * @tparam Level Verbosity level of the log message (the message will be ignored if Config's log level is higher)
+ * Sink writing into a file opened (and owned) by the sink.
  */
-template<LogLevel Level>
-class Log {
+class FileSink : public Sink {
 public:
-    static constexpr bool isActive{Level >= Config::logLevel};
-
-    explicit Log(std::ostream &stream = Config::getDefaultStream<Level>(),
-            const std::source_location location = std::source_location::current()) :
-            m_stream(isActive ? stream : nullStream) {
-        if constexpr (isActive) {
-            *this << "[";
-            printTime();
-            *this << "][" << logLevelToString(Level) << "][";
-            printFileName(location.file_name());
-            *this << ":" << location.line() << "]";
-            if constexpr (Config::includeFunctionSignature) {
-                *this << "[" << location.function_name() << "]";
-            }
-            *this << " ";
-        }
+    explicit FileSink(const std::string &fileName, std::ios_base::openmode mode = std::ios_base::out) :
+            m_file(fileName, mode) {
     }
 
-    ~Log() {
-        if constexpr (isActive) {
-            m_stream << std::endl;
-        }
+    void write(std::string_view text, bool flush) override {
+        detail::writeLocked(m_file, text, flush);
     }
 
-    std::ostream &getStream() {
-        return m_stream;
+    void flush() override {
+        detail::flushLocked(m_file);
     }
 
-    template<typename T>
-    Log &operator<<(const T &token) {
-        if constexpr (isActive) {
-            m_stream << token;
-        }
-        return *this;
+    std::ofstream &file() {
+        return m_file;
     }
 
 private:
-    static inline std::ostream nullStream{nullptr};
-    std::ostream &m_stream;
-
-    /**
-     * Very efficient (and simplistic) implementation of log timestamp.
-     *
-     * Using the STL's timezone-supporting implementation and format strings would slow down the logging by a lot.
-     */
-    void printTime() {
-        auto now = std::chrono::high_resolution_clock::now();
-        auto timeSinceEpoch = now.time_since_epoch();
-        auto h = std::chrono::duration_cast<std::chrono::hours>(timeSinceEpoch).count() % 24
-                + Config::timezoneAdjustment;
-        auto min = std::chrono::duration_cast<std::chrono::minutes>(timeSinceEpoch).count() % 60;
-        auto s = std::chrono::duration_cast<std::chrono::seconds>(timeSinceEpoch).count() % 60;
-        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(timeSinceEpoch).count() % 100;
-
-        *this << std::setfill('0') << std::setw(2) << h << ":"
-              << std::setfill('0') << std::setw(2) << min << ":"
-              << std::setfill('0') << std::setw(2) << s << "."
-              << std::setfill('0') << std::setw(3) << ms;
-    }
-
-    void printFileName(const char* filePath) {
-        const char* slashPosition = std::strrchr(filePath, '/');
-        if (slashPosition != nullptr) {
-            *this << slashPosition + 1;
-        } else {
-            *this << filePath;
-        }
-    }
+    std::ofstream m_file;
 };
 
-} // simple_logger
-
 /**
- * Comment out this definition to disable convenience macros if you don't like them.
+ * Block until all messages logged so far are written to their streams and the streams are flushed.
+ *
+ * Useful in asynchronous mode (e.g. before a graceful restart), synchronous messages are flushed right away.
  */
-#define SIMPLE_LOGGER_ENABLE_MACROS
+SIMPLE_LOGGER_API void flush();
 
-#ifdef SIMPLE_LOGGER_ENABLE_MACROS
+/**
+ * Write all pending messages and stop the background thread (in asynchronous mode), waiting at most `timeout`.
+ *
+ * Messages logged afterwards (e.g. by static destructors) are written directly by the logging thread.
+ * This also happens automatically at exit, call it earlier to control the order of shutdown.
+ * @return false if the timeout expired before all messages were written (the background thread keeps writing them)
+ */
+SIMPLE_LOGGER_API bool shutdown(std::chrono::milliseconds timeout = std::chrono::milliseconds{5000});
 
 /**
- * Log message on a given level to default output stream with a single stream chain.
+ * Install handlers of fatal signals (SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT) which write messages still waiting for
+ * the background thread into the log file, followed by a "crashed with signal N" message, and re-raise the signal.
+ *
+ * The handlers are async-signal-safe: messages are formatted into a buffer allocated here (and truncated to it), and
+ * arguments which would need user code to be formatted (deferred Formatters) are written as a placeholder.
+ * The current log file is opened (for appending) right away, call this again after changing it using Sinks.
+ * The handlers run on an alternate signal stack (so that stack overflows are reported too), given to the calling thread
+ * and to each thread logging for the first time afterwards (unless it already has one).
+ * Previously installed handlers of the signals are restored before re-raising it. Only available on POSIX systems.
  */
-#define SIMPLE_LOGGER_LOG(level) if constexpr(simple_logger::Log<simple_logger::LogLevel::level>::isActive) \
-    simple_logger::Log<simple_logger::LogLevel::level>()
+SIMPLE_LOGGER_API void installCrashHandlers();
+
+
+} // simple_logger
 
 /**
- * Log a trace message with a single stream chain.
+ * The backend is only defined in the compiled library's source file if SIMPLE_LOGGER_COMPILED is used.
  */
-#define LOG_TRACE SIMPLE_LOGGER_LOG(Trace)
+#if !defined(SIMPLE_LOGGER_COMPILED) || defined(SIMPLE_LOGGER_IMPLEMENTATION)
+
+#include <iostream>
+#include <condition_variable>
+#include <mutex>
+#include <numeric>
+#include <thread>
+
+#if __has_include(<pthread.h>) && __has_include(<unistd.h>) && __has_include(<fcntl.h>)
+#include <cerrno>
+#include <csignal>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <unistd.h>
+#define SIMPLE_LOGGER_POSIX
+#endif
+
+namespace simple_logger {
+
+SIMPLE_LOGGER_API std::string Config::logFileName{std::string(logLevelToString(logLevel)) + ".log"};
+
+SIMPLE_LOGGER_API std::ostream *Config::standardOutput() {
+    return &std::cout;
+}
+
+namespace detail {
 
 /**
- * Log a debug message with a single stream chain.
+ * Stream of a record buffer, kept in the buffer's stream storage (or allocated if it doesn't fit there).
  */
-#define LOG_DEBUG SIMPLE_LOGGER_LOG(Debug)
+struct RecordStream {
+    explicit RecordStream(RecordBuffer &buffer) : streamBuffer(buffer) {
+    }
+
+    RecordStreamBuffer streamBuffer;
+    std::ostream stream{&streamBuffer};
+};
+
+inline constexpr bool recordStreamFits{sizeof(RecordStream) <= RecordBuffer::streamCapacity
+        && alignof(RecordStream) <= alignof(std::max_align_t)};
+
+} // detail
+
+SIMPLE_LOGGER_API std::ostream &RecordBuffer::stream() {
+    if (m_stream == nullptr) {
+        if constexpr (detail::recordStreamFits) {
+            m_stream = &(new (m_streamStorage) detail::RecordStream(*this))->stream;
+        } else {
+            auto *recordStream = new detail::RecordStream(*this);
+            std::memcpy(m_streamStorage, &recordStream, sizeof(recordStream));
+            m_stream = &recordStream->stream;
+        }
+    }
+    return *m_stream;
+}
+
+SIMPLE_LOGGER_API bool RecordBuffer::streamHasDefaultFormat(FormatKind kind) const {
+    std::ios_base::fmtflags flags{};
+    switch (kind) {
+        case FormatKind::Text: break;
+        case FormatKind::Boolean: flags = std::ios_base::boolalpha; break;
+        case FormatKind::Integer: flags = std::ios_base::basefield | std::ios_base::showpos | std::ios_base::showbase;
+            break;
+        case FormatKind::Floating:
+            if (m_stream->precision() != 6) {
+                return false;
+            }
+            flags = std::ios_base::floatfield | std::ios_base::showpos | std::ios_base::showpoint
+                    | std::ios_base::uppercase;
+            break;
+    }
+    constexpr std::ios_base::fmtflags defaultFlags{std::ios_base::skipws | std::ios_base::dec};
+    return (m_stream->flags() & flags) == (defaultFlags & flags) && m_stream->width() == 0;
+}
+
+SIMPLE_LOGGER_API void RecordBuffer::closeStream() {
+    if constexpr (detail::recordStreamFits) {
+        std::launder(reinterpret_cast<detail::RecordStream *>(m_streamStorage))->~RecordStream();
+    } else {
+        detail::RecordStream *recordStream;
+        std::memcpy(&recordStream, m_streamStorage, sizeof(recordStream));
+        delete recordStream;
+    }
+    m_stream = nullptr;
+}
+
+namespace detail {
+
+SIMPLE_LOGGER_COLD SIMPLE_LOGGER_API void printWithStream(RecordBuffer &buffer, char token) {
+    buffer.stream() << token;
+}
+
+SIMPLE_LOGGER_COLD SIMPLE_LOGGER_API void printWithStream(RecordBuffer &buffer, bool token) {
+    buffer.stream() << token;
+}
+
+SIMPLE_LOGGER_COLD SIMPLE_LOGGER_API void printWithStream(RecordBuffer &buffer, short token) {
+    buffer.stream() << token;
+}
+
+SIMPLE_LOGGER_COLD SIMPLE_LOGGER_API void printWithStream(RecordBuffer &buffer, unsigned short token) {
+    buffer.stream() << token;
+}
+
+SIMPLE_LOGGER_COLD SIMPLE_LOGGER_API void printWithStream(RecordBuffer &buffer, int token) {
+    buffer.stream() << token;
+}
+
+SIMPLE_LOGGER_COLD SIMPLE_LOGGER_API void printWithStream(RecordBuffer &buffer, unsigned int token) {
+    buffer.stream() << token;
+}
+
+SIMPLE_LOGGER_COLD SIMPLE_LOGGER_API void printWithStream(RecordBuffer &buffer, long token) {
+    buffer.stream() << token;
+}
+
+SIMPLE_LOGGER_COLD SIMPLE_LOGGER_API void printWithStream(RecordBuffer &buffer, unsigned long token) {
+    buffer.stream() << token;
+}
+
+SIMPLE_LOGGER_COLD SIMPLE_LOGGER_API void printWithStream(RecordBuffer &buffer, long long token) {
+    buffer.stream() << token;
+}
+
+SIMPLE_LOGGER_COLD SIMPLE_LOGGER_API void printWithStream(RecordBuffer &buffer, unsigned long long token) {
+    buffer.stream() << token;
+}
+
+SIMPLE_LOGGER_COLD SIMPLE_LOGGER_API void printWithStream(RecordBuffer &buffer, float token) {
+    buffer.stream() << token;
+}
+
+SIMPLE_LOGGER_COLD SIMPLE_LOGGER_API void printWithStream(RecordBuffer &buffer, double token) {
+    buffer.stream() << token;
+}
+
+SIMPLE_LOGGER_COLD SIMPLE_LOGGER_API void printWithStream(RecordBuffer &buffer, long double token) {
+    buffer.stream() << token;
+}
+
+SIMPLE_LOGGER_COLD SIMPLE_LOGGER_API void printWithStream(RecordBuffer &buffer, const char *token) {
+    buffer.stream() << token;
+}
+
+SIMPLE_LOGGER_COLD SIMPLE_LOGGER_API void printWithStream(RecordBuffer &buffer, std::string_view token) {
+    buffer.stream() << token;
+}
+
+SIMPLE_LOGGER_COLD SIMPLE_LOGGER_API void printFloatWithStream(RecordBuffer &buffer, long double value,
+        std::chars_format format, int precision) {
+    std::ostream &stream{buffer.stream()};
+    auto flags = stream.flags();
+    auto oldPrecision = stream.precision(precision);
+    stream.setf(format == std::chars_format::fixed ? std::ios_base::fixed : std::ios_base::scientific,
+            std::ios_base::floatfield);
+    stream << value;
+    stream.flags(flags);
+    stream.precision(oldPrecision);
+}
+
+SIMPLE_LOGGER_API std::ostream &nullStream() {
+    static std::ostream stream{nullptr};
+    return stream;
+}
+
+#if !defined(__x86_64__) && !defined(__i386__)
+SIMPLE_LOGGER_API std::uint64_t steadyTicks() {
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+#endif
+
+} // detail
+
+namespace detail {
 
 /**
- * Log an info message with a single stream chain.
+ * Copy of Config::logFileName made when it's destroyed, so that static destructors running afterwards can still log.
  */
-#define LOG_INFO SIMPLE_LOGGER_LOG(Info)
+inline const std::string *finalLogFileName{nullptr};
+
+struct LogFileNameKeeper {
+    ~LogFileNameKeeper() {
+        // intentionally never destroyed
+        finalLogFileName = new std::string(Config::logFileName);
+    }
+};
+
+// defined after Config::logFileName, hence destroyed before it
+inline LogFileNameKeeper logFileNameKeeper;
+
+inline const std::string &initialLogFileName() {
+    return finalLogFileName != nullptr ? *finalLogFileName : Config::logFileName;
+}
+
+} // detail
+
+namespace detail {
 
 /**
- * Log a warning message with a single stream chain.
+ * Conversion of durations measured by readTicks() to nanoseconds.
  */
-#define LOG_WARNING SIMPLE_LOGGER_LOG(Warning)
+class TickClock {
+public:
+    static TickClock &instance() {
+        static TickClock clock;
+        return clock;
+    }
+
+    double nanosecondsPerTick() const {
+#if defined(__x86_64__) || defined(__i386__)
+        // calibrate the timestamp counter against the steady clock over at least 10 ms
+        auto elapsed = std::chrono::steady_clock::now() - m_startTime;
+        if (elapsed < std::chrono::milliseconds{10}) {
+            std::this_thread::sleep_for(std::chrono::milliseconds{10} - elapsed);
+        }
+        std::uint64_t ticks{readTicks() - m_startTicks};
+        std::chrono::duration<double, std::nano> time{std::chrono::steady_clock::now() - m_startTime};
+        return time.count() / static_cast<double>(ticks);
+#else
+        return 1.0;
+#endif
+    }
+
+private:
+    // reference point for converting ticks to nanoseconds
+    const std::uint64_t m_startTicks{readTicks()};
+    const std::chrono::steady_clock::time_point m_startTime{std::chrono::steady_clock::now()};
+};
 
 /**
- * Log an error message with a single stream chain.
+ * Add to a counter which is only ever modified by the calling thread (without an atomic read-modify-write operation).
  */
-#define LOG_ERROR SIMPLE_LOGGER_LOG(Error)
+inline void addOwned(std::atomic<std::uint64_t> &counter, std::uint64_t value = 1) {
+    counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
 
 /**
- * Create a local instance of a log on a given level and get the logger's default stream as a variable of given name.
+ * Counters updated by each thread separately (see addOwned()) and merged when read.
  *
- * Use this macro (or derived macros) for more detailed log message control, e.g. giving the stream as a function
- * argument.
+ * Counters of exited threads are added to shared totals.
+ * @tparam Counters Atomic counters of a thread, with a `Totals` type and `void addTo(Totals &totals) const`
+ */
+template<typename Counters>
+class PerThreadCounters {
+public:
+    using Totals = typename Counters::Totals;
+
+    Counters &local() {
+        thread_local CountersOwner owner{this};
+        if (owner.counters == nullptr) {
+            owner.counters = new Counters();
+            std::lock_guard lock{m_mutex};
+            m_threads.push_back(owner.counters);
+        }
+        return *owner.counters;
+    }
+
+    Totals total() {
+        std::lock_guard lock{m_mutex};
+        Totals totals{m_exited};
+        for (const Counters *counters : m_threads) {
+            counters->addTo(totals);
+        }
+        return totals;
+    }
+
+    /**
+     * Prevent registration and merging of counters while the process is forking.
+     */
+    void lockForFork() {
+        m_mutex.lock();
+    }
+
+    void unlockAfterFork() {
+        m_mutex.unlock();
+    }
+
+private:
+    /**
+     * Moves the thread's counters to the shared totals when the thread exits.
+     */
+    struct CountersOwner {
+        PerThreadCounters *registry;
+        Counters *counters{nullptr};
+
+        ~CountersOwner() {
+            if (counters != nullptr) {
+                registry->retire(counters);
+            }
+        }
+    };
+
+    std::mutex m_mutex;
+    std::vector<const Counters *> m_threads;
+    Totals m_exited{};
+
+    void retire(Counters *counters) {
+        {
+            std::lock_guard lock{m_mutex};
+            counters->addTo(m_exited);
+            std::erase(m_threads, counters);
+        }
+        delete counters;
+    }
+};
+
+/**
+ * Per-thread histograms of durations of log messages for each level, merged when requested.
  */
-#define GET_LOG_STREAM(level, name) \
-    simple_logger::Log<simple_logger::LogLevel::level> _sl_log{}; std::ostream &name = _sl_log.getStream()
+class LatencyRecorder {
+public:
+    static LatencyRecorder &instance() {
+        // intentionally never destroyed, so that it can be used even by static destructors
+        static auto *recorder{new LatencyRecorder()};
+        return *recorder;
+    }
+
+    void record(LogLevel level, std::uint64_t ticks) {
+        addOwned(m_counters.local().buckets[static_cast<std::size_t>(level)][LogLinearBuckets::index(ticks)]);
+    }
+
+    Histogram snapshot(LogLevel level) {
+        Histogram histogram{TickClock::instance().nanosecondsPerTick()};
+        auto totals = m_counters.total();
+        for (std::size_t i = 0; i < LogLinearBuckets::count; ++i) {
+            histogram.addToBucket(i, totals[static_cast<std::size_t>(level)][i]);
+        }
+        return histogram;
+    }
+
+    void lockForFork() {
+        m_counters.lockForFork();
+    }
+
+    void unlockAfterFork() {
+        m_counters.unlockAfterFork();
+    }
+
+private:
+    struct Counters {
+        using Totals = std::array<std::array<std::uint64_t, LogLinearBuckets::count>, logLevelCount>;
+
+        std::array<std::array<std::atomic<std::uint64_t>, LogLinearBuckets::count>, logLevelCount> buckets{};
+
+        void addTo(Totals &totals) const {
+            for (std::size_t level = 0; level < logLevelCount; ++level) {
+                for (std::size_t i = 0; i < LogLinearBuckets::count; ++i) {
+                    totals[level][i] += buckets[level][i].load(std::memory_order_relaxed);
+                }
+            }
+        }
+    };
+
+    PerThreadCounters<Counters> m_counters;
+
+    LatencyRecorder() {
+        TickClock::instance();
+    }
+};
+
+SIMPLE_LOGGER_API void recordLatency(LogLevel level, std::uint64_t ticks) {
+    LatencyRecorder::instance().record(level, ticks);
+}
+
+} // detail
+
+SIMPLE_LOGGER_API Histogram logLatency(LogLevel level) {
+    return detail::LatencyRecorder::instance().snapshot(level);
+}
+
+namespace detail {
 
 /**
- * Create a local instance of a debug log and get the logger's default stream as a variable of given name.
+ * Per-thread counters of the logger's work, merged into Stats when requested.
  */
-#define GET_LOG_STREAM_TRACE(name) GET_LOG_STREAM(Trace, name)
+class StatsRecorder {
+public:
+    static StatsRecorder &instance() {
+        // intentionally never destroyed, so that it can be used even by static destructors
+        static auto *recorder{new StatsRecorder()};
+        return *recorder;
+    }
+
+    void message(LogLevel level, std::size_t bytes) {
+        Counters &counters{m_counters.local()};
+        addOwned(counters.messages[static_cast<std::size_t>(level)]);
+        addOwned(counters.bytes[static_cast<std::size_t>(level)], bytes);
+    }
+
+    void dropped() {
+        addOwned(m_counters.local().dropped);
+    }
+
+    void queueFullWait() {
+        addOwned(m_counters.local().queueFullWaits);
+    }
+
+    void queueUsage(std::size_t bytes) {
+        auto &watermark = m_counters.local().queueHighWatermark;
+        if (bytes > watermark.load(std::memory_order_relaxed)) {
+            watermark.store(bytes, std::memory_order_relaxed);
+        }
+    }
+
+    void flush(std::uint64_t ticks) {
+        addOwned(m_counters.local().flushDurations[LogLinearBuckets::index(ticks)]);
+    }
+
+    void writerBusy(std::uint64_t ticks) {
+        addOwned(m_counters.local().writerBusyTicks, ticks);
+    }
+
+    Stats snapshot() {
+        auto totals = m_counters.total();
+        double nanosecondsPerTick{TickClock::instance().nanosecondsPerTick()};
+        Stats stats{.messages = totals.messages, .bytes = totals.bytes, .dropped = totals.dropped,
+                .queueFullWaits = totals.queueFullWaits, .queueHighWatermark = totals.queueHighWatermark,
+                .flushDurations = Histogram{nanosecondsPerTick}};
+        for (std::size_t i = 0; i < LogLinearBuckets::count; ++i) {
+            stats.flushDurations.addToBucket(i, totals.flushDurations[i]);
+        }
+        stats.writerBusyTime = std::chrono::nanoseconds{
+                static_cast<std::int64_t>(static_cast<double>(totals.writerBusyTicks) * nanosecondsPerTick)};
+        return stats;
+    }
+
+    void lockForFork() {
+        m_counters.lockForFork();
+    }
+
+    void unlockAfterFork() {
+        m_counters.unlockAfterFork();
+    }
+
+private:
+    struct Counters {
+        struct Totals {
+            std::array<std::uint64_t, logLevelCount> messages{};
+            std::array<std::uint64_t, logLevelCount> bytes{};
+            std::uint64_t dropped{0};
+            std::uint64_t queueFullWaits{0};
+            std::uint64_t queueHighWatermark{0};
+            std::array<std::uint64_t, LogLinearBuckets::count> flushDurations{};
+            std::uint64_t writerBusyTicks{0};
+        };
+
+        std::array<std::atomic<std::uint64_t>, logLevelCount> messages{};
+        std::array<std::atomic<std::uint64_t>, logLevelCount> bytes{};
+        std::atomic<std::uint64_t> dropped{0};
+        std::atomic<std::uint64_t> queueFullWaits{0};
+        std::atomic<std::uint64_t> queueHighWatermark{0};
+        std::array<std::atomic<std::uint64_t>, LogLinearBuckets::count> flushDurations{};
+        std::atomic<std::uint64_t> writerBusyTicks{0};
+
+        void addTo(Totals &totals) const {
+            for (std::size_t level = 0; level < logLevelCount; ++level) {
+                totals.messages[level] += messages[level].load(std::memory_order_relaxed);
+                totals.bytes[level] += bytes[level].load(std::memory_order_relaxed);
+            }
+            totals.dropped += dropped.load(std::memory_order_relaxed);
+            totals.queueFullWaits += queueFullWaits.load(std::memory_order_relaxed);
+            totals.queueHighWatermark = std::max(totals.queueHighWatermark,
+                    queueHighWatermark.load(std::memory_order_relaxed));
+            for (std::size_t i = 0; i < LogLinearBuckets::count; ++i) {
+                totals.flushDurations[i] += flushDurations[i].load(std::memory_order_relaxed);
+            }
+            totals.writerBusyTicks += writerBusyTicks.load(std::memory_order_relaxed);
+        }
+    };
+
+    PerThreadCounters<Counters> m_counters;
+
+    StatsRecorder() {
+        TickClock::instance();
+    }
+};
+
+SIMPLE_LOGGER_API void countMessage(LogLevel level, std::size_t bytes) {
+    if constexpr (Config::collectStats) {
+        StatsRecorder::instance().message(level, bytes);
+    }
+}
 
 /**
- * Create a local instance of a debug log and get the logger's default stream as a variable of given name.
+ * Run a flush of a stream or sink, measuring its duration if statistics are collected.
  */
-#define GET_LOG_STREAM_DEBUG(name) GET_LOG_STREAM(Debug, name)
+template<typename F>
+void timedFlush(F &&flush) {
+    if constexpr (Config::collectStats) {
+        std::uint64_t start{readTicks()};
+        flush();
+        StatsRecorder::instance().flush(readTicks() - start);
+    } else {
+        flush();
+    }
+}
+
+} // detail
+
+SIMPLE_LOGGER_API Stats stats() {
+    return detail::StatsRecorder::instance().snapshot();
+}
+
+SIMPLE_LOGGER_API std::vector<CallSiteStats> noisiestCallSites(std::size_t count) {
+    std::vector<CallSiteStats> sites;
+    detail::CallSite::forEach([&sites](const std::source_location &location, LogLevel level, std::uint64_t messages,
+            std::uint64_t bytes) {
+        if (messages != 0) {
+            sites.push_back({location.file_name(), location.line(), level, messages, bytes});
+        }
+    });
+    auto noisier = [](const CallSiteStats &a, const CallSiteStats &b) { return a.bytes > b.bytes; };
+    if (sites.size() > count) {
+        std::partial_sort(sites.begin(), sites.begin() + static_cast<std::ptrdiff_t>(count), sites.end(), noisier);
+        sites.resize(count);
+    } else {
+        std::sort(sites.begin(), sites.end(), noisier);
+    }
+    return sites;
+}
+
+namespace detail {
 
 /**
- * Create a local instance of an info log and get the logger's default stream as a variable of given name.
+ * Make sure logging keeps working in child processes created by fork() (defined at the end of the file).
  */
-#define GET_LOG_STREAM_INFO(name) GET_LOG_STREAM(Info, name)
+inline void registerForkHandlers();
 
 /**
- * Create a local instance of a warning log and get the logger's default stream as a variable of given name.
+ * Give the calling thread an alternate stack for the crash handlers if they are installed (defined at the end of the
+ * file).
  */
-#define GET_LOG_STREAM_WARNING(name) GET_LOG_STREAM(Warning, name)
+inline void prepareCrashStack();
 
 /**
- * Create a local instance of an error log and get the logger's default stream as a variable of given name.
+ * Lock of a stream, claimed by the first stream using it (and never released, streams aren't tracked).
  */
-#define GET_LOG_STREAM_ERROR(name) GET_LOG_STREAM(Error, name)
+struct alignas(64) StreamLock {
+    std::atomic<const std::ostream *> stream{nullptr};
+    std::mutex mutex;
+};
+
+inline constexpr std::size_t streamLockCount{256};
+// slots tried before falling back to sharing the stream's first slot
+inline constexpr std::size_t streamLockProbes{8};
 
-#endif // SIMPLE_LOGGER_ENABLE_MACROS
+inline StreamLock *streamLocks() {
+    // intentionally never destroyed, so that it can be used even by static destructors
+    static auto *locks{(registerForkHandlers(), new StreamLock[streamLockCount])};
+    return locks;
+}
+
+/**
+ * Locks serializing writes of whole messages into streams, so that concurrent messages don't interleave.
+ *
+ * Each stream claims a lock of its own among a few slots selected by its address, so that flushing a slow stream
+ * doesn't block messages written into other streams. Only when all of those slots are taken (e.g. by many short-lived
+ * streams) the stream shares its first slot's lock. Locks are only held while copying a finished message into the
+ * stream (and flushing it), never while formatting.
+ */
+inline std::mutex &streamMutex(const std::ostream *stream) {
+    auto address = reinterpret_cast<std::uintptr_t>(stream);
+    std::size_t first{(address ^ (address >> 12)) / alignof(std::max_align_t) % streamLockCount};
+    StreamLock *locks{streamLocks()};
+    for (std::size_t probe = 0; probe < streamLockProbes; ++probe) {
+        StreamLock &lock{locks[(first + probe) % streamLockCount]};
+        const std::ostream *owner{lock.stream.load(std::memory_order_acquire)};
+        if (owner == nullptr && lock.stream.compare_exchange_strong(owner, stream, std::memory_order_acq_rel)) {
+            return lock.mutex;
+        }
+        if (owner == stream) {
+            return lock.mutex;
+        }
+    }
+    return locks[first].mutex;
+}
+
+SIMPLE_LOGGER_API void writeLocked(std::ostream &stream, std::string_view text, bool flush) {
+    std::lock_guard lock{streamMutex(&stream)};
+    stream.write(text.data(), static_cast<std::streamsize>(text.size()));
+    if (flush) {
+        timedFlush([&stream] { stream.flush(); });
+    }
+    if constexpr (Config::collectStats) {
+        if (!stream) {
+            StatsRecorder::instance().dropped();
+        }
+    }
+}
+
+SIMPLE_LOGGER_API void flushLocked(std::ostream &stream) {
+    std::lock_guard lock{streamMutex(&stream)};
+    stream.flush();
+}
+
+} // detail
+
+namespace detail {
+
+/**
+ * Configuration of sinks, never modified once published (changes create a new snapshot).
+ */
+struct SinkSnapshot {
+    std::array<std::vector<std::shared_ptr<Sink>>, logLevelCount> levels;
+    std::string logFileName;
+    std::shared_ptr<Sink> logFile;
+};
+
+/**
+ * Registry of sinks used by log messages without explicit stream.
+ *
+ * Logging threads read the current snapshot without any locking, only announcing it in their hazard pointer.
+ * Changes publish a new snapshot and retire the old one without waiting for readers: retired snapshots are deleted by
+ * the next change, or by the next reader finishing after them, once no thread announces them anymore.
+ */
+class SinkRegistry {
+    struct Hazard;
+
+public:
+    static SinkRegistry &instance() {
+        // intentionally never destroyed, so that it can be used even by static destructors
+        static auto *registry{new SinkRegistry()};
+        return *registry;
+    }
+
+    /**
+     * The registry if it was already created, null otherwise.
+     */
+    static SinkRegistry *existing() {
+        return s_instance.load(std::memory_order_acquire);
+    }
+
+    /**
+     * Prevent changes of the registry while the process is forking.
+     */
+    void lockForFork() {
+        m_updateMutex.lock();
+    }
+
+    void unlockAfterFork() {
+        m_updateMutex.unlock();
+    }
+
+    /**
+     * Release hazard pointers of threads which don't exist in a forked child process.
+     */
+    void resetAfterForkInChild() {
+        const Hazard *ownHazard{t_hazard};
+        for (Hazard *hazard = m_hazards.load(std::memory_order_acquire); hazard != nullptr; hazard = hazard->next) {
+            if (hazard != ownHazard) {
+                hazard->pointer.store(nullptr, std::memory_order_relaxed);
+                hazard->depth = 0;
+                hazard->used.store(false, std::memory_order_release);
+            }
+        }
+    }
+
+    /**
+     * Access to the current snapshot, valid for the lifetime of the reader.
+     */
+    class Reader {
+    public:
+        explicit Reader(SinkRegistry &registry) : m_registry(registry), m_hazard(registry.threadHazard()) {
+            if (m_hazard.depth++ > 0) {
+                // nested reader (e.g. a sink logging), the snapshot is already protected
+                m_snapshot = m_hazard.pointer.load(std::memory_order_relaxed);
+                return;
+            }
+            m_snapshot = registry.m_current.load(std::memory_order_acquire);
+            while (true) {
+                m_hazard.pointer.store(m_snapshot, std::memory_order_seq_cst);
+                const SinkSnapshot *current{registry.m_current.load(std::memory_order_seq_cst)};
+                if (current == m_snapshot) {
+                    break;
+                }
+                m_snapshot = current;
+            }
+        }
+
+        Reader(const Reader &) = delete;
+        Reader &operator=(const Reader &) = delete;
+
+        ~Reader() {
+            if (--m_hazard.depth == 0) {
+                m_hazard.pointer.store(nullptr, std::memory_order_release);
+                if (t_threadExiting) {
+                    m_hazard.used.store(false, std::memory_order_release);
+                    t_hazard = nullptr;
+                }
+                // a reader missing a just retired snapshot leaves it to the next one
+                if (m_registry.m_hasRetired.load(std::memory_order_relaxed)) {
+                    m_registry.tryReclaim();
+                }
+            }
+        }
+
+        const SinkSnapshot &snapshot() const {
+            return *m_snapshot;
+        }
+
+    private:
+        SinkRegistry &m_registry;
+        Hazard &m_hazard;
+        const SinkSnapshot *m_snapshot;
+    };
+
+    /**
+     * Create a new snapshot by applying a change to a copy of the current one and publish it.
+     */
+    template<typename F>
+    void update(F &&change) {
+        std::lock_guard lock{m_updateMutex};
+        auto next = std::make_unique<SinkSnapshot>(*m_current.load(std::memory_order_relaxed));
+        change(*next);
+        const SinkSnapshot *previous{m_current.exchange(next.release(), std::memory_order_seq_cst)};
+        // readers may still use the previous snapshot (e.g. the background thread during a whole pass of writing)
+        m_retired.push_back(previous);
+        m_hasRetired.store(true, std::memory_order_relaxed);
+        reclaim();
+    }
+
+private:
+    struct alignas(64) Hazard {
+        std::atomic<const SinkSnapshot *> pointer{nullptr};
+        std::atomic<bool> used{true};
+        std::size_t depth{0};
+        Hazard *next{nullptr};
+    };
+
+    /**
+     * Releases the thread's hazard pointer for reuse when the thread exits.
+     */
+    struct HazardReleaser {
+        ~HazardReleaser() {
+            if (t_hazard != nullptr) {
+                t_hazard->used.store(false, std::memory_order_release);
+                t_hazard = nullptr;
+            }
+            t_threadExiting = true;
+        }
+    };
+
+    static inline thread_local Hazard *t_hazard{nullptr};
+    // set once the thread's thread_local objects are being destroyed, readers then release the hazard themselves
+    static inline thread_local bool t_threadExiting{false};
+    // set while the thread deletes snapshots, sinks logging from their destructors mustn't reclaim again
+    static inline thread_local bool t_reclaiming{false};
+
+    static inline std::atomic<SinkRegistry *> s_instance{nullptr};
+
+    std::atomic<const SinkSnapshot *> m_current;
+    std::atomic<Hazard *> m_hazards{nullptr};
+    std::mutex m_updateMutex;
+    // guarded by m_updateMutex
+    std::vector<const SinkSnapshot *> m_retired;
+    std::atomic<bool> m_hasRetired{false};
+
+    SinkRegistry() {
+        auto snapshot = std::make_unique<SinkSnapshot>();
+        snapshot->logFileName = initialLogFileName();
+        addDefaultSink<LogLevel::Trace>(*snapshot);
+        addDefaultSink<LogLevel::Debug>(*snapshot);
+        addDefaultSink<LogLevel::Info>(*snapshot);
+        addDefaultSink<LogLevel::Warning>(*snapshot);
+        addDefaultSink<LogLevel::Error>(*snapshot);
+        m_current.store(snapshot.release());
+        registerForkHandlers();
+        s_instance.store(this, std::memory_order_release);
+    }
+
+    template<LogLevel Level>
+    static void addDefaultSink(SinkSnapshot &snapshot) {
+        std::ostream *stream{Config::defaultOutput<Level>()};
+        std::shared_ptr<Sink> sink;
+        if (stream == Config::logFile) {
+            if (!snapshot.logFile) {
+                snapshot.logFile = std::make_shared<FileSink>(snapshot.logFileName);
+            }
+            sink = snapshot.logFile;
+        } else {
+            // share sinks of the same stream
+            for (const auto &sinks : snapshot.levels) {
+                for (const auto &existing : sinks) {
+                    auto *streamSink = dynamic_cast<StreamSink *>(existing.get());
+                    if (streamSink != nullptr && &streamSink->stream() == stream) {
+                        sink = existing;
+                    }
+                }
+            }
+            if (!sink) {
+                sink = std::make_shared<StreamSink>(*stream);
+            }
+        }
+        snapshot.levels[static_cast<std::size_t>(Level)].push_back(std::move(sink));
+    }
+
+    Hazard &threadHazard() {
+        if (t_hazard == nullptr) {
+            t_hazard = acquireHazard();
+            if (!t_threadExiting) {
+                thread_local HazardReleaser releaser{};
+                prepareCrashStack();
+            }
+        }
+        return *t_hazard;
+    }
+
+    Hazard *acquireHazard() {
+        for (Hazard *hazard = m_hazards.load(std::memory_order_acquire); hazard != nullptr; hazard = hazard->next) {
+            bool used{false};
+            if (hazard->used.compare_exchange_strong(used, true, std::memory_order_acquire)) {
+                return hazard;
+            }
+        }
+        auto *hazard = new Hazard();
+        hazard->next = m_hazards.load(std::memory_order_relaxed);
+        while (!m_hazards.compare_exchange_weak(hazard->next, hazard, std::memory_order_release)) {
+        }
+        return hazard;
+    }
+
+    /**
+     * Delete retired snapshots no longer announced by any thread (with m_updateMutex held).
+     */
+    void reclaim() {
+        if (t_reclaiming) {
+            return;
+        }
+        t_reclaiming = true;
+        std::vector<const SinkSnapshot *> unused;
+        std::erase_if(m_retired, [this, &unused](const SinkSnapshot *snapshot) {
+            for (Hazard *hazard = m_hazards.load(std::memory_order_acquire); hazard != nullptr;
+                    hazard = hazard->next) {
+                if (hazard->pointer.load(std::memory_order_seq_cst) == snapshot) {
+                    return false;
+                }
+            }
+            unused.push_back(snapshot);
+            return true;
+        });
+        m_hasRetired.store(!m_retired.empty(), std::memory_order_relaxed);
+        for (const SinkSnapshot *snapshot : unused) {
+            delete snapshot;
+        }
+        t_reclaiming = false;
+    }
+
+    /**
+     * Reclaim retired snapshots unless a change (or another reader) is already doing it.
+     */
+    void tryReclaim() {
+        if (t_reclaiming) {
+            return;
+        }
+        std::unique_lock lock{m_updateMutex, std::try_to_lock};
+        if (lock.owns_lock()) {
+            reclaim();
+        }
+    }
+};
+
+} // detail
+
+namespace detail {
+
+/**
+ * Reopen the log file under its (possibly new) name, used by Sinks.
+ */
+inline void replaceLogFile(detail::SinkSnapshot &snapshot) {
+    if (!snapshot.logFile) {
+        // not used yet, will be opened with the new name when needed
+        return;
+    }
+    auto file = std::make_shared<FileSink>(snapshot.logFileName, std::ios_base::app);
+    for (auto &sinks : snapshot.levels) {
+        std::replace(sinks.begin(), sinks.end(), snapshot.logFile, std::shared_ptr<Sink>(file));
+    }
+    snapshot.logFile = std::move(file);
+}
+
+} // detail
+
+SIMPLE_LOGGER_API void Sinks::set(LogLevel level, std::vector<std::shared_ptr<Sink>> sinks) {
+    detail::SinkRegistry::instance().update([&sinks, level](detail::SinkSnapshot &snapshot) {
+        snapshot.levels[static_cast<std::size_t>(level)] = std::move(sinks);
+    });
+}
+
+SIMPLE_LOGGER_API void Sinks::add(LogLevel level, std::shared_ptr<Sink> sink) {
+    detail::SinkRegistry::instance().update([&sink, level](detail::SinkSnapshot &snapshot) {
+        snapshot.levels[static_cast<std::size_t>(level)].push_back(std::move(sink));
+    });
+}
+
+SIMPLE_LOGGER_API std::shared_ptr<Sink> Sinks::logFile() {
+    {
+        detail::SinkRegistry::Reader reader{detail::SinkRegistry::instance()};
+        if (reader.snapshot().logFile) {
+            return reader.snapshot().logFile;
+        }
+    }
+    detail::SinkRegistry::instance().update([](detail::SinkSnapshot &snapshot) {
+        if (!snapshot.logFile) {
+            snapshot.logFile = std::make_shared<FileSink>(snapshot.logFileName);
+        }
+    });
+    return logFile();
+}
+
+namespace detail {
+
+/**
+ * Stream buffer forwarding everything to the sink of the current log file (whichever file it is at the moment).
+ */
+class LogFileBuffer : public std::streambuf {
+protected:
+    int_type overflow(int_type character) override {
+        if (!traits_type::eq_int_type(character, traits_type::eof())) {
+            char text{traits_type::to_char_type(character)};
+            Sinks::logFile()->write({&text, 1}, false);
+        }
+        return traits_type::not_eof(character);
+    }
+
+    std::streamsize xsputn(const char *text, std::streamsize count) override {
+        Sinks::logFile()->write({text, static_cast<std::size_t>(count)}, false);
+        return count;
+    }
+
+    int sync() override {
+        Sinks::logFile()->flush();
+        return 0;
+    }
+};
+
+} // detail
+
+SIMPLE_LOGGER_API std::ofstream &Config::getLogFile() {
+    // intentionally never destroyed, every returned file stays open (and valid) until exit
+    static auto *retained{new std::vector<std::shared_ptr<Sink>>()};
+    static std::mutex mutex;
+    std::shared_ptr<Sink> sink{Sinks::logFile()};
+    std::lock_guard lock{mutex};
+    if (std::find(retained->begin(), retained->end(), sink) == retained->end()) {
+        retained->push_back(sink);
+    }
+    return static_cast<FileSink &>(*sink).file();
+}
+
+SIMPLE_LOGGER_API std::ostream &Config::currentLogFile() {
+    // intentionally never destroyed, so that it can be used from destructors of static objects as well
+    static auto *stream{new std::ostream(new detail::LogFileBuffer())};
+    return *stream;
+}
+
+SIMPLE_LOGGER_API void Sinks::setLogFile(std::string fileName) {
+    detail::SinkRegistry::instance().update([&fileName](detail::SinkSnapshot &snapshot) {
+        snapshot.logFileName = std::move(fileName);
+        detail::replaceLogFile(snapshot);
+    });
+}
+
+SIMPLE_LOGGER_API void Sinks::reopenLogFile() {
+    detail::SinkRegistry::instance().update([](detail::SinkSnapshot &snapshot) {
+        detail::replaceLogFile(snapshot);
+    });
+}
+
+namespace detail {
+
+using Clock = std::chrono::high_resolution_clock;
+
+/**
+ * Header of an asynchronous log message, followed by its captured arguments.
+ */
+struct CapturedRecord {
+    struct NoCallSite {
+        NoCallSite() = default;
+
+        NoCallSite(CallSite *) {
+        }
+    };
+
+    Clock::time_point time;
+    std::source_location location;
+    // null for the level's sinks, messages to custom streams are never handed over to the background thread
+    std::ostream *stream;
+    LogLevel level;
+    [[no_unique_address]] std::conditional_t<Config::profileCallSites, CallSite *, NoCallSite> site{};
+};
+
+/**
+ * Very efficient (and simplistic) implementation of log timestamp.
+ *
+ * Using the STL's timezone-supporting implementation and format strings would slow down the logging by a lot.
+ */
+inline void printTime(RecordBuffer &buffer, Clock::time_point time) {
+    auto timeSinceEpoch = time.time_since_epoch();
+    auto h = (std::chrono::duration_cast<std::chrono::hours>(timeSinceEpoch).count()
+            + Config::timezoneAdjustment % 24 + 24) % 24;
+    auto min = std::chrono::duration_cast<std::chrono::minutes>(timeSinceEpoch).count() % 60;
+    auto s = std::chrono::duration_cast<std::chrono::seconds>(timeSinceEpoch).count() % 60;
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(timeSinceEpoch).count() % 1000;
+
+    char *out{buffer.reserve(12)};
+    out[0] = static_cast<char>('0' + h / 10);
+    out[1] = static_cast<char>('0' + h % 10);
+    out[2] = ':';
+    out[3] = static_cast<char>('0' + min / 10);
+    out[4] = static_cast<char>('0' + min % 10);
+    out[5] = ':';
+    out[6] = static_cast<char>('0' + s / 10);
+    out[7] = static_cast<char>('0' + s % 10);
+    out[8] = '.';
+    out[9] = static_cast<char>('0' + ms / 100);
+    out[10] = static_cast<char>('0' + ms / 10 % 10);
+    out[11] = static_cast<char>('0' + ms % 10);
+    buffer.commit(12);
+}
+
+inline void printFileName(RecordBuffer &buffer, const char* filePath) {
+    const char* slashPosition = std::strrchr(filePath, '/');
+    if (slashPosition != nullptr) {
+        buffer.append(slashPosition + 1);
+    } else {
+        buffer.append(filePath);
+    }
+}
+
+/**
+ * Print the prefix of a log message, e.g. "[16:44:24.078][Info][example.cpp:6] ".
+ */
+SIMPLE_LOGGER_API void printPrefix(RecordBuffer &buffer, LogLevel level, Clock::time_point time,
+        const std::source_location &location) {
+    buffer.append('[');
+    printTime(buffer, time);
+    buffer.append("][");
+    buffer.append(logLevelToString(level));
+    buffer.append("][");
+    printFileName(buffer, location.file_name());
+    buffer.append(':');
+    printInteger(buffer, location.line());
+    buffer.append(']');
+    if constexpr (Config::includeFunctionSignature) {
+        buffer.append('[');
+        buffer.append(location.function_name());
+        buffer.append(']');
+    }
+    buffer.append(' ');
+}
+
+SIMPLE_LOGGER_NOINLINE SIMPLE_LOGGER_API void beginRecord(RecordBuffer &buffer, LogLevel level,
+        const std::source_location &location) {
+    printPrefix(buffer, level, Clock::now(), location);
+}
+
+SIMPLE_LOGGER_NOINLINE SIMPLE_LOGGER_API void beginCapture(RecordBuffer &buffer, LogLevel level,
+        std::ostream *stream, const std::source_location &location, CallSite *site) {
+    CapturedRecord header{Clock::now(), location, stream, level, site};
+    buffer.append(std::string_view(reinterpret_cast<const char *>(&header), sizeof(header)));
+}
+
+/**
+ * Format a captured log message, including its prefix and terminating newline.
+ */
+inline void formatRecord(std::span<const std::byte> record, RecordBuffer &buffer) {
+    CapturedRecord header;
+    std::memcpy(&header, record.data(), sizeof(header));
+    printPrefix(buffer, header.level, header.time, header.location);
+    for (std::size_t offset = sizeof(header); offset < record.size();) {
+        CapturedArgument argument;
+        std::memcpy(&argument, record.data() + offset, sizeof(argument));
+        offset += sizeof(argument);
+        argument.print(record.data() + offset, argument.size, buffer);
+        offset += argument.size;
+    }
+    buffer.append('\n');
+}
+
+inline CapturedRecord recordHeader(std::span<const std::byte> record) {
+    CapturedRecord header;
+    std::memcpy(&header, record.data(), sizeof(header));
+    return header;
+}
+
+template<typename... T>
+bool printsCapturedValueOf(PrintCaptured print) {
+    return ((print == &printCapturedValue<T>) || ...);
+}
+
+/**
+ * Maximum length of a captured argument's text if it can be printed in a signal handler, i.e. without running user
+ * code or allocating (text, bytes and arithmetic values), an empty optional otherwise.
+ */
+inline std::optional<std::size_t> signalSafeLength(const CapturedArgument &argument) {
+    if (argument.print == &printCapturedText) {
+        return argument.size;
+    } else if (argument.print == &printCapturedBytes<false>) {
+        return 2 * argument.size;
+    } else if (argument.print == &printCapturedBytes<true>) {
+        return (argument.size + hexdumpBytesPerLine - 1) / hexdumpBytesPerLine * hexdumpLineLength;
+    } else if (printsCapturedValueOf<char, bool, short, unsigned short, int, unsigned int, long, unsigned long,
+            long long, unsigned long long, float, double>(argument.print)) {
+        // long double is left out, std::to_chars may fall back to printf for it
+        return 64;
+    }
+    return std::nullopt;
+}
+
+/**
+ * Format a captured log message in a signal handler, including its prefix and terminating newline.
+ *
+ * Nothing is allocated, the message is truncated to the space available in the buffer (which must be reserved
+ * beforehand), and arguments which need a Formatter or stream operator of a user type are replaced by a placeholder.
+ */
+inline void formatRecordAfterCrash(std::span<const std::byte> record, RecordBuffer &buffer) {
+    constexpr std::string_view placeholder{"<unformatted>"};
+    constexpr std::string_view truncated{"<truncated>\n"};
+    CapturedRecord header{recordHeader(record)};
+    std::size_t prefixLength{64 + std::strlen(header.location.file_name())};
+    if constexpr (Config::includeFunctionSignature) {
+        prefixLength += std::strlen(header.location.function_name());
+    }
+    if (buffer.available() < prefixLength + truncated.size()) {
+        return;
+    }
+    printPrefix(buffer, header.level, header.time, header.location);
+    for (std::size_t offset = sizeof(header); offset < record.size();) {
+        CapturedArgument argument;
+        std::memcpy(&argument, record.data() + offset, sizeof(argument));
+        offset += sizeof(argument);
+        std::optional<std::size_t> length{signalSafeLength(argument)};
+        std::size_t room{buffer.available() - truncated.size()};
+        if (length.value_or(placeholder.size()) > room) {
+            if (argument.print == &printCapturedText) {
+                buffer.append(std::string_view(reinterpret_cast<const char *>(record.data() + offset), room));
+            }
+            buffer.append(truncated);
+            return;
+        }
+        if (length) {
+            argument.print(record.data() + offset, argument.size, buffer);
+        } else {
+            buffer.append(placeholder);
+        }
+        offset += argument.size;
+    }
+    buffer.append('\n');
+}
+
+inline Clock::time_point recordTime(std::span<const std::byte> record) {
+    return recordHeader(record).time;
+}
+
+inline void addToCallSite(CallSite *site, std::size_t bytes) {
+    if (site != nullptr) {
+        site->add(bytes);
+    }
+}
+
+inline void addToCallSite(CapturedRecord::NoCallSite, std::size_t) {
+}
+
+inline void countMessage(const CapturedRecord &header, std::size_t bytes) {
+    countMessage(header.level, bytes);
+    addToCallSite(header.site, bytes);
+}
+
+SIMPLE_LOGGER_API void writeToSinks(LogLevel level, std::string_view text) {
+    SinkRegistry::Reader reader{SinkRegistry::instance()};
+    for (const auto &sink : reader.snapshot().levels[static_cast<std::size_t>(level)]) {
+        sink->write(text, true);
+    }
+}
+
+SIMPLE_LOGGER_API void writeRecord(std::span<const std::byte> record) {
+    RecordBuffer text;
+    formatRecord(record, text);
+    CapturedRecord header{recordHeader(record)};
+    countMessage(header, text.size());
+    if (header.stream != nullptr) {
+        writeLocked(*header.stream, text.view(), true);
+    } else {
+        writeToSinks(header.level, text.view());
+    }
+}
+
+/**
+ * Lock-free queue of captured log messages, written by a single logging thread and read by the background thread.
+ *
+ * Messages are stored in a ring buffer, each one contiguously (space at the end of the buffer is skipped if needed).
+ */
+class RecordQueue {
+public:
+    explicit RecordQueue(std::size_t capacity) : m_capacity(capacity), m_data(std::make_unique<std::byte[]>(capacity)) {
+    }
+
+    /**
+     * Largest message that can be stored in the queue, larger ones need to be stored indirectly.
+     */
+    std::size_t maxRecordSize() const {
+        return m_capacity / 4;
+    }
+
+    bool tryPush(std::span<const std::byte> record, bool indirect = false) {
+        std::size_t blockSize{alignedSize(record.size())};
+        std::size_t head{m_head.load(std::memory_order_relaxed)};
+        std::size_t offset{head & (m_capacity - 1)};
+        std::size_t skipped{m_capacity - offset < blockSize ? m_capacity - offset : 0};
+        if (head + skipped + blockSize - m_cachedTail > m_capacity) {
+            m_cachedTail = m_tail.load(std::memory_order_acquire);
+            if (head + skipped + blockSize - m_cachedTail > m_capacity) {
+                return false;
+            }
+        }
+        if (skipped > 0) {
+            BlockHeader marker{skippedSpace};
+            std::memcpy(&m_data[offset], &marker, sizeof(marker));
+            head += skipped;
+            offset = 0;
+        }
+        BlockHeader header{record.size() | (indirect ? indirectFlag : 0)};
+        std::memcpy(&m_data[offset], &header, sizeof(header));
+        std::memcpy(&m_data[offset + sizeof(header)], record.data(), record.size());
+        m_head.store(head + blockSize, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Oldest message in the queue (empty if there is none).
+     */
+    std::span<const std::byte> front() {
+        std::size_t tail{m_tail.load(std::memory_order_relaxed)};
+        if (tail == m_cachedHead) {
+            m_cachedHead = m_head.load(std::memory_order_acquire);
+            if (tail == m_cachedHead) {
+                return {};
+            }
+            if constexpr (Config::collectStats) {
+                StatsRecorder::instance().queueUsage(m_cachedHead - tail);
+            }
+        }
+        std::size_t offset{tail & (m_capacity - 1)};
+        BlockHeader header;
+        std::memcpy(&header, &m_data[offset], sizeof(header));
+        if (header == skippedSpace) {
+            m_tail.store(tail + m_capacity - offset, std::memory_order_release);
+            offset = 0;
+            std::memcpy(&header, &m_data[offset], sizeof(header));
+        }
+        std::size_t size{header & ~indirectFlag};
+        m_frontSize = alignedSize(size);
+        m_frontIndirect = (header & indirectFlag) != 0;
+        if (m_frontIndirect) {
+            std::memcpy(&m_front, &m_data[offset + sizeof(header)], sizeof(m_front));
+        } else {
+            m_front = {&m_data[offset + sizeof(header)], size};
+        }
+        return m_front;
+    }
+
+    /**
+     * Remove the message previously returned by front().
+     */
+    void pop() {
+        if (m_frontIndirect) {
+            delete[] m_front.data();
+        }
+        m_tail.store(m_tail.load(std::memory_order_relaxed) + m_frontSize, std::memory_order_release);
+    }
+
+    bool empty() const {
+        return m_head.load(std::memory_order_acquire) == m_tail.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Position of the oldest message, for reading messages with peek() without removing them.
+     */
+    std::size_t tail() const {
+        return m_tail.load(std::memory_order_acquire);
+    }
+
+    /**
+     * Message at a position (obtained from tail() or a previous peek()) without removing it, or empty at the end.
+     *
+     * Used when the process crashes, the position is advanced to the next message.
+     */
+    std::span<const std::byte> peek(std::size_t &position) const {
+        if (position == m_head.load(std::memory_order_acquire)) {
+            return {};
+        }
+        std::size_t offset{position & (m_capacity - 1)};
+        BlockHeader header;
+        std::memcpy(&header, &m_data[offset], sizeof(header));
+        if (header == skippedSpace) {
+            position += m_capacity - offset;
+            offset = 0;
+            std::memcpy(&header, &m_data[offset], sizeof(header));
+        }
+        std::size_t size{header & ~indirectFlag};
+        position += alignedSize(size);
+        if ((header & indirectFlag) != 0) {
+            std::span<const std::byte> record;
+            std::memcpy(&record, &m_data[offset + sizeof(header)], sizeof(record));
+            return record;
+        }
+        return {&m_data[offset + sizeof(header)], size};
+    }
+
+    /**
+     * Mark the queue as no longer used by its logging thread (it can be removed once empty).
+     */
+    void close() {
+        m_closed.store(true, std::memory_order_release);
+    }
+
+    bool closed() const {
+        return m_closed.load(std::memory_order_acquire);
+    }
+
+private:
+    using BlockHeader = std::size_t;
+    static constexpr BlockHeader skippedSpace{std::numeric_limits<BlockHeader>::max()};
+    static constexpr BlockHeader indirectFlag{BlockHeader{1} << (std::numeric_limits<BlockHeader>::digits - 2)};
+
+    const std::size_t m_capacity;
+    std::unique_ptr<std::byte[]> m_data;
+    std::atomic<bool> m_closed{false};
+    // producer's data
+    alignas(64) std::atomic<std::size_t> m_head{0};
+    std::size_t m_cachedTail{0};
+    // consumer's data
+    alignas(64) std::atomic<std::size_t> m_tail{0};
+    std::size_t m_cachedHead{0};
+    std::span<const std::byte> m_front;
+    std::size_t m_frontSize{0};
+    bool m_frontIndirect{false};
+
+    static std::size_t alignedSize(std::size_t recordSize) {
+        constexpr std::size_t alignment{alignof(BlockHeader)};
+        return (sizeof(BlockHeader) + recordSize + alignment - 1) / alignment * alignment;
+    }
+};
+
+/**
+ * Batch of captured log messages, formatted together by a formatter thread and then written by the background thread.
+ */
+class RecordBatch {
+public:
+    void add(std::span<const std::byte> record) {
+        m_records.insert(m_records.end(), record.begin(), record.end());
+        m_entries.push_back({m_records.size(), 0});
+    }
+
+    std::size_t size() const {
+        return m_entries.size();
+    }
+
+    std::span<const std::byte> record(std::size_t index) const {
+        std::size_t begin{index > 0 ? m_entries[index - 1].recordEnd : 0};
+        return {m_records.data() + begin, m_entries[index].recordEnd - begin};
+    }
+
+    /**
+     * Formatted text of a message, available after format().
+     */
+    std::string_view text(std::size_t index) const {
+        std::size_t begin{index > 0 ? m_entries[index - 1].textEnd : 0};
+        return std::string_view(m_text).substr(begin, m_entries[index].textEnd - begin);
+    }
+
+    /**
+     * Format all messages, each one separately in the scratch buffer (so that manipulators don't leak to others).
+     */
+    void format(RecordBuffer &scratch) {
+        for (std::size_t i = 0; i < m_entries.size(); ++i) {
+            scratch.clear();
+            formatRecord(record(i), scratch);
+            m_text.append(scratch.view());
+            m_entries[i].textEnd = m_text.size();
+        }
+    }
+
+    void clear() {
+        m_records.clear();
+        m_entries.clear();
+        m_text.clear();
+    }
+
+    void reserve(std::size_t messages) {
+        m_entries.reserve(messages);
+    }
+
+private:
+    struct Entry {
+        std::size_t recordEnd;
+        std::size_t textEnd;
+    };
+
+    std::vector<std::byte> m_records;
+    std::vector<Entry> m_entries;
+    std::string m_text;
+};
+
+/**
+ * Background thread writing asynchronous log messages, collected from queues of all logging threads.
+ *
+ * Messages are written in the order of their timestamps and streams are flushed whenever all queues are drained.
+ * If Config::asyncFormatterThreads is set, the background thread only collects messages into batches, which are
+ * formatted by a pool of formatter threads and written by the background thread in the order they were collected.
+ */
+class AsyncBackend {
+public:
+    static AsyncBackend &instance() {
+        AsyncBackend *backend{s_instance.load(std::memory_order_acquire)};
+        return backend != nullptr ? *backend : create();
+    }
+
+    /**
+     * Hand over a finished message to the background thread.
+     *
+     * Blocks if the thread's queue is full. If the background thread isn't running (e.g. the program is exiting), the
+     * message is written directly.
+     */
+    void push(std::span<const std::byte> record) {
+        pushToQueue(record, true);
+    }
+
+    /**
+     * Hand over a finished message to the background thread unless the thread's queue is full.
+     */
+    bool tryPush(std::span<const std::byte> record) {
+        return pushToQueue(record, false);
+    }
+
+    /**
+     * Set the executor of coroutines suspended on the calling thread (see pushAndResume()).
+     */
+    static void setExecutor(CoroutineExecutor executor, void *context) {
+        t_executor = executor;
+        t_executorContext = context;
+    }
+
+    /**
+     * Hand over a message which didn't fit into the thread's queue, the background thread resumes the suspended
+     * coroutine once the message is written.
+     *
+     * Returns false if the message was written right away (the coroutine must not be suspended then).
+     */
+    bool pushAndResume(WaitingRecord &waiting) {
+        waiting.executor = t_executor;
+        waiting.executorContext = t_executorContext;
+        waiting.next = nullptr;
+        bool queued{false};
+        {
+            std::lock_guard lock{m_mutex};
+            // the background thread (or the thread stopping it) takes waiting messages until it's stopped
+            if (!m_stopping.load(std::memory_order_acquire)) {
+                insertWaiting(waiting);
+                queued = true;
+            }
+        }
+        if (!queued) {
+            writeRecord(waiting.record);
+            return false;
+        }
+        if constexpr (Config::collectStats) {
+            StatsRecorder::instance().queueFullWait();
+        }
+        wake();
+        return true;
+    }
+
+    /**
+     * Write all pending messages and pause the background thread before forking (formatter threads stay idle).
+     */
+    static void prepareFork() {
+        s_creationMutex.lock();
+        AsyncBackend *backend{s_instance.load(std::memory_order_relaxed)};
+        if (backend == nullptr || t_isBackgroundThread) {
+            return;
+        }
+        std::unique_lock lock{backend->m_wakeMutex};
+        backend->m_pauseRequested = true;
+        backend->m_wakeRequested = true;
+        backend->m_wakeCondition.notify_one();
+        backend->m_stateCondition.wait(lock, [backend] { return backend->m_paused || !backend->m_running; });
+    }
+
+    static void resumeAfterFork() {
+        AsyncBackend *backend{s_instance.load(std::memory_order_relaxed)};
+        if (backend != nullptr && !t_isBackgroundThread) {
+            {
+                std::lock_guard lock{backend->m_wakeMutex};
+                backend->m_pauseRequested = false;
+            }
+            backend->m_stateCondition.notify_all();
+        }
+        s_creationMutex.unlock();
+    }
+
+    /**
+     * Abandon the backend in a forked child process, where its threads don't exist.
+     *
+     * Messages still in the queues belong to the parent, which writes them. A new backend with empty queues is created
+     * on the next message.
+     */
+    static void resetAfterForkInChild() {
+        s_instance.store(nullptr, std::memory_order_release);
+        t_queue = nullptr;
+        t_queueClosed = false;
+        s_creationMutex.unlock();
+    }
+
+    /**
+     * Block until all messages handed over so far are written and their streams flushed.
+     */
+    void flush() {
+        if (t_isBackgroundThread || m_stopped.load(std::memory_order_acquire)) {
+            // nothing is pending (or the caller is the one writing it)
+            return;
+        }
+        std::unique_lock lock{m_wakeMutex};
+        std::size_t ticket{m_flushRequested.fetch_add(1, std::memory_order_seq_cst) + 1};
+        m_wakeRequested = true;
+        m_wakeCondition.notify_one();
+        m_stateCondition.wait(lock, [this, ticket] { return m_flushCompleted >= ticket || !m_running; });
+    }
+
+#ifdef SIMPLE_LOGGER_POSIX
+    /**
+     * Write messages which haven't been written yet when the process crashed, called from a signal handler.
+     *
+     * The background thread is given a moment to flush what it already wrote and stop at a point where the queues are
+     * consistent (it never continues). If it doesn't stop in time, the pending messages are given up rather than read
+     * while it may be changing them. Messages are formatted by the calling thread into `text` (see
+     * formatRecordAfterCrash()) and passed to `output`.
+     */
+    template<typename F>
+    static void writePendingAfterCrash(RecordBuffer &text, F &&output) {
+        s_crashing.store(true, std::memory_order_release);
+        AsyncBackend *backend{s_instance.load(std::memory_order_acquire)};
+        if (backend == nullptr || backend->m_stopped.load(std::memory_order_acquire)) {
+            return;
+        }
+        if (!t_isBackgroundThread) {
+            // the background thread checks for the crash at least once per poll interval
+            for (int i = 0; i < 200 && !backend->m_parked.load(std::memory_order_acquire); ++i) {
+                ::poll(nullptr, 0, 1);
+            }
+            if (!backend->m_parked.load(std::memory_order_acquire)) {
+                return;
+            }
+        }
+        auto writeRecord = [&text, &output](std::span<const std::byte> record) {
+            text.clear();
+            formatRecordAfterCrash(record, text);
+            output(text.view());
+        };
+        // batches taken out of the queues are older than anything left in them
+        for (std::size_t i = 0; i < backend->m_formattingBatches.size(); ++i) {
+            const RecordBatch &batch{*backend->m_formattingBatches[i]};
+            for (std::size_t j = i == 0 ? backend->m_batchWritten : 0; j < batch.size(); ++j) {
+                writeRecord(batch.record(j));
+            }
+        }
+        if (backend->m_batch) {
+            for (std::size_t j = 0; j < backend->m_batch->size(); ++j) {
+                writeRecord(backend->m_batch->record(j));
+            }
+        }
+        // queues are merged by timestamps like by the background thread, up to a fixed number (no allocation here)
+        constexpr std::size_t maxMergedQueues{256};
+        const auto &queues = backend->m_activeQueues;
+        std::size_t mergedCount{std::min(queues.size(), maxMergedQueues)};
+        std::array<std::size_t, maxMergedQueues> positions;
+        for (std::size_t i = 0; i < mergedCount; ++i) {
+            positions[i] = queues[i]->tail();
+        }
+        while (true) {
+            std::size_t earliest{mergedCount};
+            std::span<const std::byte> earliestRecord;
+            for (std::size_t i = 0; i < mergedCount; ++i) {
+                std::size_t position{positions[i]};
+                std::span<const std::byte> record{queues[i]->peek(position)};
+                if (!record.empty() && (earliest == mergedCount || recordTime(record) < recordTime(earliestRecord))) {
+                    earliest = i;
+                    earliestRecord = record;
+                }
+            }
+            if (earliest == mergedCount) {
+                break;
+            }
+            queues[earliest]->peek(positions[earliest]);
+            writeRecord(earliestRecord);
+        }
+        for (std::size_t i = mergedCount; i < queues.size(); ++i) {
+            std::size_t position{queues[i]->tail()};
+            for (auto record = queues[i]->peek(position); !record.empty(); record = queues[i]->peek(position)) {
+                writeRecord(record);
+            }
+        }
+    }
+#endif
+
+    /**
+     * Write all pending messages and stop the background thread, messages logged afterwards are written directly.
+     *
+     * Returns false if the background thread didn't finish within the timeout (it still finishes later), if given.
+     */
+    bool stop(std::optional<std::chrono::milliseconds> timeout = std::nullopt) {
+        if (t_isBackgroundThread) {
+            return false;
+        }
+        std::lock_guard stopLock{m_stopMutex};
+        if (m_stopped.load(std::memory_order_acquire)) {
+            return true;
+        }
+        m_stopping.store(true, std::memory_order_release);
+        wake();
+        if (timeout) {
+            std::unique_lock lock{m_wakeMutex};
+            if (!m_stateCondition.wait_for(lock, *timeout, [this] { return !m_running; })) {
+                return false;
+            }
+        }
+        m_thread.join();
+        m_stopped.store(true, std::memory_order_release);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        // messages which arrived while the background thread was finishing (later ones are written by their threads,
+        // see writePendingIfStopped())
+        writePending();
+        resumeWaiting();
+        return true;
+    }
+
+private:
+    struct StopAtExit {
+        ~StopAtExit() {
+            AsyncBackend *backend{s_instance.load(std::memory_order_acquire)};
+            if (backend != nullptr) {
+                backend->stop();
+            }
+        }
+    };
+
+    /**
+     * Threads formatting batches of messages, in any order and independently of each other.
+     */
+    class FormatterPool {
+    public:
+        void start(std::size_t threadCount) {
+            // at most this many batches are given to the threads at once (see submitBatch())
+            m_pending.reserve(2 * threadCount);
+            m_done.reserve(2 * threadCount);
+            for (std::size_t i = 0; i < threadCount; ++i) {
+                m_threads.emplace_back(&FormatterPool::run, this);
+            }
+        }
+
+        void stop() {
+            {
+                std::lock_guard lock{m_mutex};
+                m_stopping = true;
+            }
+            m_workAvailable.notify_all();
+            for (auto &thread : m_threads) {
+                thread.join();
+            }
+            m_threads.clear();
+        }
+
+        bool running() const {
+            return !m_threads.empty();
+        }
+
+        void submit(RecordBatch &batch) {
+            {
+                std::lock_guard lock{m_mutex};
+                m_pending.push_back(&batch);
+            }
+            m_workAvailable.notify_one();
+        }
+
+        bool formatted(const RecordBatch &batch) {
+            std::lock_guard lock{m_mutex};
+            return std::find(m_done.begin(), m_done.end(), &batch) != m_done.end();
+        }
+
+        /**
+         * Wait until a submitted batch is formatted.
+         */
+        void wait(const RecordBatch &batch) {
+            std::unique_lock lock{m_mutex};
+            m_batchFormatted.wait(lock, [this, &batch] {
+                return std::find(m_done.begin(), m_done.end(), &batch) != m_done.end();
+            });
+            std::erase(m_done, &batch);
+        }
+
+    private:
+        std::mutex m_mutex;
+        std::condition_variable m_workAvailable;
+        std::condition_variable m_batchFormatted;
+        // short FIFO, a vector doesn't allocate once reserved (unlike a deque cycling through its blocks)
+        std::vector<RecordBatch *> m_pending;
+        std::vector<const RecordBatch *> m_done;
+        bool m_stopping{false};
+        std::vector<std::thread> m_threads;
+
+        void run() {
+            t_isBackgroundThread = true;
+            RecordBuffer scratch;
+            std::unique_lock lock{m_mutex};
+            while (true) {
+                m_workAvailable.wait(lock, [this] { return m_stopping || !m_pending.empty(); });
+                if (m_pending.empty()) {
+                    return;
+                }
+                RecordBatch *batch{m_pending.front()};
+                m_pending.erase(m_pending.begin());
+                lock.unlock();
+                batch->format(scratch);
+                lock.lock();
+                m_done.push_back(batch);
+                m_batchFormatted.notify_all();
+            }
+        }
+    };
+
+    /**
+     * Closes the thread's queue when the thread exits.
+     */
+    struct QueueCloser {
+        ~QueueCloser() {
+            if (t_queue != nullptr) {
+                t_queue->close();
+                t_queue = nullptr;
+            }
+            t_queueClosed = true;
+        }
+    };
+
+    static inline std::atomic<AsyncBackend *> s_instance{nullptr};
+    static inline std::atomic<bool> s_crashing{false};
+    static inline std::mutex s_creationMutex;
+    static inline thread_local RecordQueue *t_queue{nullptr};
+    static inline thread_local bool t_queueClosed{false};
+    static inline thread_local bool t_isBackgroundThread{false};
+    static inline thread_local CoroutineExecutor t_executor{nullptr};
+    static inline thread_local void *t_executorContext{nullptr};
+
+    std::mutex m_mutex;
+    std::vector<std::shared_ptr<RecordQueue>> m_queues;
+    std::vector<std::vector<std::byte>> m_orphans;
+    // messages of suspended coroutines ordered by time (owned by the coroutines)
+    WaitingRecord *m_waiting{nullptr};
+    WaitingRecord *m_waitingTail{nullptr};
+    std::atomic<std::size_t> m_queuesVersion{0};
+
+    std::mutex m_wakeMutex;
+    std::condition_variable m_wakeCondition;
+    bool m_wakeRequested{false};
+    std::atomic<bool> m_stopping{false};
+    std::atomic<bool> m_stopped{false};
+    std::mutex m_stopMutex;
+    // state of the background thread for flushing, stopping and pausing while forking (guarded by m_wakeMutex)
+    std::condition_variable m_stateCondition;
+    std::atomic<std::size_t> m_flushRequested{0};
+    std::size_t m_flushCompleted{0};
+    bool m_pauseRequested{false};
+    bool m_paused{false};
+    bool m_running{true};
+    // state for writing pending messages when the process crashes
+    std::atomic<bool> m_parked{false};
+    std::size_t m_batchWritten{0};
+    std::thread m_thread;
+
+    // data of the consumer, i.e. the background thread (or the thread which stopped it)
+    std::vector<std::shared_ptr<RecordQueue>> m_activeQueues;
+    std::size_t m_activeQueuesVersion{0};
+    std::vector<std::vector<std::byte>> m_activeOrphans;
+    WaitingRecord *m_activeWaiting{nullptr};
+    // messages already written, whose coroutines are resumed after the whole pass
+    WaitingRecord *m_resumable{nullptr};
+    WaitingRecord *m_resumableTail{nullptr};
+    std::vector<Sink *> m_writtenSinks;
+    RecordBuffer m_text;
+    FormatterPool m_formatters;
+    // batches being collected, formatted (in the order of collection) and reused
+    std::unique_ptr<RecordBatch> m_batch;
+    std::vector<std::unique_ptr<RecordBatch>> m_formattingBatches;
+    std::vector<std::unique_ptr<RecordBatch>> m_freeBatches;
+
+    AsyncBackend() {
+        m_formatters.start(Config::asyncFormatterThreads);
+        // all batches which can be in use at once (see submitBatch()), so that none is allocated while logging
+        m_formattingBatches.reserve(2 * Config::asyncFormatterThreads);
+        for (std::size_t i = 0; Config::asyncFormatterThreads > 0 && i <= 2 * Config::asyncFormatterThreads; ++i) {
+            m_freeBatches.push_back(std::make_unique<RecordBatch>());
+            m_freeBatches.back()->reserve(Config::asyncBatchSize);
+        }
+        m_thread = std::thread(&AsyncBackend::run, this);
+    }
+
+    static AsyncBackend &create() {
+        std::lock_guard lock{s_creationMutex};
+        AsyncBackend *backend{s_instance.load(std::memory_order_relaxed)};
+        if (backend == nullptr) {
+            // intentionally never destroyed, so that it can be used even by static destructors
+            backend = new AsyncBackend();
+            registerForkHandlers();
+            static StopAtExit stopAtExit{};
+            s_instance.store(backend, std::memory_order_release);
+        }
+        return *backend;
+    }
+
+    RecordQueue *threadQueue() {
+        if (t_queue == nullptr && !t_queueClosed) {
+            static_assert(std::has_single_bit(Config::asyncBufferSize), "Queue size must be a power of 2");
+            auto queue = std::make_shared<RecordQueue>(Config::asyncBufferSize);
+            {
+                std::lock_guard lock{m_mutex};
+                m_queues.push_back(queue);
+                m_queuesVersion.fetch_add(1, std::memory_order_release);
+            }
+            t_queue = queue.get();
+            thread_local QueueCloser closer{};
+            prepareCrashStack();
+        }
+        return t_queue;
+    }
+
+    bool pushToQueue(std::span<const std::byte> record, bool block) {
+        if (t_isBackgroundThread || m_stopped.load(std::memory_order_acquire)) {
+            writeRecord(record);
+            return true;
+        }
+        RecordQueue *queue{threadQueue()};
+        if (queue == nullptr) {
+            std::lock_guard lock{m_mutex};
+            m_orphans.emplace_back(record.begin(), record.end());
+            return true;
+        }
+        if (record.size() > queue->maxRecordSize()) {
+            auto *copy = new std::byte[record.size()];
+            std::memcpy(copy, record.data(), record.size());
+            std::span<const std::byte> indirect{copy, record.size()};
+            std::span<const std::byte> pointer{reinterpret_cast<const std::byte *>(&indirect), sizeof(indirect)};
+            if (block) {
+                pushBlocking(*queue, pointer, true);
+            } else if (!queue->tryPush(pointer, true)) {
+                delete[] copy;
+                return false;
+            }
+        } else if (block) {
+            pushBlocking(*queue, record, false);
+        } else if (!queue->tryPush(record, false)) {
+            return false;
+        }
+        writePendingIfStopped();
+        return true;
+    }
+
+    void pushBlocking(RecordQueue &queue, std::span<const std::byte> block, bool indirect) {
+        if (queue.tryPush(block, indirect)) {
+            return;
+        }
+        if constexpr (Config::collectStats) {
+            StatsRecorder::instance().queueFullWait();
+        }
+        do {
+            // the queue is drained by the calling thread once the background thread is stopped
+            if (!writePendingIfStopped()) {
+                wake();
+            }
+            std::this_thread::yield();
+        } while (!queue.tryPush(block, indirect));
+    }
+
+    /**
+     * Write pending messages on the calling thread if the backend was stopped, returns false if it wasn't.
+     *
+     * Called after pushing a message: a thread which checked m_stopped before stop() set it may push the message after
+     * stop()'s final writePending(), and nothing else would ever write it then.
+     */
+    bool writePendingIfStopped() {
+        // pairs with the fence in stop(): either stop() sees the pushed message, or this thread sees m_stopped
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!m_stopped.load(std::memory_order_relaxed)) {
+            return false;
+        }
+        std::lock_guard stopLock{m_stopMutex};
+        writePending();
+        return true;
+    }
+
+    void wake() {
+        {
+            std::lock_guard lock{m_wakeMutex};
+            m_wakeRequested = true;
+        }
+        m_wakeCondition.notify_one();
+    }
+
+    void run() {
+        t_isBackgroundThread = true;
+        constexpr std::chrono::seconds statsInterval{Config::statsIntervalSeconds};
+        auto nextStats = std::chrono::steady_clock::now() + statsInterval;
+        while (true) {
+            std::size_t flushRequested{m_flushRequested.load(std::memory_order_acquire)};
+            std::uint64_t start{readTicks()};
+            bool written{writePending()};
+            if constexpr (Config::collectStats) {
+                if (written) {
+                    StatsRecorder::instance().writerBusy(readTicks() - start);
+                }
+            }
+            resumeWaiting();
+            if constexpr (Config::statsIntervalSeconds > 0) {
+                if (std::chrono::steady_clock::now() >= nextStats) {
+                    nextStats += statsInterval;
+                    logStats();
+                }
+            }
+            std::unique_lock lock{m_wakeMutex};
+            if (m_flushCompleted < flushRequested) {
+                m_flushCompleted = flushRequested;
+                m_stateCondition.notify_all();
+            }
+            if (m_pauseRequested) {
+                m_paused = true;
+                m_stateCondition.notify_all();
+                m_stateCondition.wait(lock, [this] { return !m_pauseRequested; });
+                m_paused = false;
+                continue;
+            }
+            if (written) {
+                continue;
+            }
+            if (m_stopping.load(std::memory_order_acquire)) {
+                break;
+            }
+            m_wakeCondition.wait_for(lock, std::chrono::milliseconds{Config::asyncPollMilliseconds},
+                    [this] { return m_wakeRequested; });
+            m_wakeRequested = false;
+        }
+        m_formatters.stop();
+        std::lock_guard lock{m_wakeMutex};
+        m_running = false;
+        m_stateCondition.notify_all();
+    }
+
+    /**
+     * Write all messages currently in the queues and flush the written sinks, returns false if there were none.
+     */
+    bool writePending() {
+        parkIfCrashing();
+        updateQueues();
+        SinkRegistry::Reader reader{SinkRegistry::instance()};
+        bool written{false};
+        for (const auto &record : m_activeOrphans) {
+            collect(record, reader.snapshot());
+            submitFullBatch(reader.snapshot());
+            written = true;
+        }
+        m_activeOrphans.clear();
+        while (true) {
+            RecordQueue *earliest{nullptr};
+            std::span<const std::byte> earliestRecord;
+            for (const auto &queue : m_activeQueues) {
+                std::span<const std::byte> record{queue->front()};
+                if (!record.empty() && (earliest == nullptr || recordTime(record) < recordTime(earliestRecord))) {
+                    earliest = queue.get();
+                    earliestRecord = record;
+                }
+            }
+            // waiting messages are merged as if they were another queue
+            if (m_activeWaiting != nullptr) {
+                WaitingRecord &waiting{*m_activeWaiting};
+                if (earliest == nullptr || recordTime(waiting.record) < recordTime(earliestRecord)) {
+                    collect(waiting.record, reader.snapshot());
+                    m_activeWaiting = waiting.next;
+                    waiting.next = nullptr;
+                    (m_resumableTail != nullptr ? m_resumableTail->next : m_resumable) = &waiting;
+                    m_resumableTail = &waiting;
+                    submitFullBatch(reader.snapshot());
+                    written = true;
+                    continue;
+                }
+            }
+            if (earliest == nullptr) {
+                submitBatch(reader.snapshot());
+                while (!m_formattingBatches.empty()) {
+                    writeFormattedBatch(reader.snapshot());
+                }
+                flushWritten();
+                return written;
+            }
+            collect(earliestRecord, reader.snapshot());
+            earliest->pop();
+            // only after the message is removed from the queue, so that it's never written twice after a crash
+            submitFullBatch(reader.snapshot());
+            written = true;
+        }
+    }
+
+    /**
+     * Resume coroutines whose messages were written, using their threads' executors (or this thread if they have none).
+     */
+    void resumeWaiting() {
+        WaitingRecord *waiting{m_resumable};
+        m_resumable = nullptr;
+        m_resumableTail = nullptr;
+        while (waiting != nullptr) {
+            // the record is destroyed with the coroutine's awaitable once it's resumed
+            WaitingRecord *next{waiting->next};
+            std::coroutine_handle<> coroutine{waiting->coroutine};
+            if (waiting->executor != nullptr) {
+                waiting->executor(coroutine, waiting->executorContext);
+            } else {
+                coroutine.resume();
+            }
+            waiting = next;
+        }
+    }
+
+    /**
+     * Add a message of a suspended coroutine to the waiting ones (with m_mutex held), keeping them ordered by time.
+     */
+    void insertWaiting(WaitingRecord &waiting) {
+        if (m_waitingTail == nullptr || recordTime(waiting.record) >= recordTime(m_waitingTail->record)) {
+            // usually the latest message
+            (m_waitingTail != nullptr ? m_waitingTail->next : m_waiting) = &waiting;
+            m_waitingTail = &waiting;
+            return;
+        }
+        WaitingRecord **link{&m_waiting};
+        while (recordTime((*link)->record) <= recordTime(waiting.record)) {
+            link = &(*link)->next;
+        }
+        waiting.next = *link;
+        *link = &waiting;
+    }
+
+    void updateQueues() {
+        std::lock_guard lock{m_mutex};
+        std::swap(m_activeOrphans, m_orphans);
+        // the previous pass wrote all waiting messages it took
+        m_activeWaiting = m_waiting;
+        m_waiting = nullptr;
+        m_waitingTail = nullptr;
+        std::erase_if(m_queues, [](const auto &queue) { return queue->closed() && queue->empty(); });
+        std::size_t version{m_queuesVersion.load(std::memory_order_acquire)};
+        if (version != m_activeQueuesVersion || m_activeQueues.size() != m_queues.size()) {
+            m_activeQueues = m_queues;
+            m_activeQueuesVersion = version;
+        }
+    }
+
+    /**
+     * Write a message taken out of a queue, or add it to the current batch for the formatter threads.
+     */
+    void collect(std::span<const std::byte> record, const SinkSnapshot &sinks) {
+        parkIfCrashing();
+        if (!m_formatters.running()) {
+            m_text.clear();
+            formatRecord(record, m_text);
+            write(recordHeader(record), m_text.view(), sinks);
+            return;
+        }
+        if (!m_batch) {
+            if (m_freeBatches.empty()) {
+                m_batch = std::make_unique<RecordBatch>();
+            } else {
+                m_batch = std::move(m_freeBatches.back());
+                m_freeBatches.pop_back();
+            }
+        }
+        m_batch->add(record);
+    }
+
+    void submitFullBatch(const SinkSnapshot &sinks) {
+        if (m_batch && m_batch->size() >= Config::asyncBatchSize) {
+            submitBatch(sinks);
+        }
+    }
+
+    void submitBatch(const SinkSnapshot &sinks) {
+        if (!m_batch) {
+            return;
+        }
+        // limit the number of batches (i.e. the memory) waiting for formatter threads
+        if (m_formattingBatches.size() >= 2 * Config::asyncFormatterThreads) {
+            writeFormattedBatch(sinks);
+        }
+        m_formatters.submit(*m_batch);
+        m_formattingBatches.push_back(std::move(m_batch));
+        while (!m_formattingBatches.empty() && m_formatters.formatted(*m_formattingBatches.front())) {
+            writeFormattedBatch(sinks);
+        }
+    }
+
+    /**
+     * Write the oldest batch given to the formatter threads, waiting until it's formatted.
+     */
+    void writeFormattedBatch(const SinkSnapshot &sinks) {
+        RecordBatch &batch{*m_formattingBatches.front()};
+        m_formatters.wait(batch);
+        for (m_batchWritten = 0; m_batchWritten < batch.size(); ++m_batchWritten) {
+            parkIfCrashing();
+            write(recordHeader(batch.record(m_batchWritten)), batch.text(m_batchWritten), sinks);
+        }
+        m_batchWritten = 0;
+        batch.clear();
+        m_freeBatches.push_back(std::move(m_formattingBatches.front()));
+        m_formattingBatches.erase(m_formattingBatches.begin());
+    }
+
+    /**
+     * Stop forever if the process is crashing, so that the signal handler can write the remaining messages.
+     */
+    void parkIfCrashing() {
+        if (s_crashing.load(std::memory_order_acquire)) {
+            // messages already written must get to the files before the ones written by the signal handler
+            flushWritten();
+            {
+                std::lock_guard lock{m_mutex};
+                m_activeQueues = m_queues;
+            }
+            m_parked.store(true, std::memory_order_release);
+            while (true) {
+                std::this_thread::sleep_for(std::chrono::seconds{1});
+            }
+        }
+    }
+
+    void write(const CapturedRecord &header, std::string_view text, const SinkSnapshot &sinks) {
+        countMessage(header, text.size());
+        for (const auto &sink : sinks.levels[static_cast<std::size_t>(header.level)]) {
+            sink->write(text, false);
+            if (std::find(m_writtenSinks.begin(), m_writtenSinks.end(), sink.get()) == m_writtenSinks.end()) {
+                m_writtenSinks.push_back(sink.get());
+            }
+        }
+    }
+
+    void flushWritten() {
+        for (Sink *sink : m_writtenSinks) {
+            timedFlush([sink] { sink->flush(); });
+        }
+        m_writtenSinks.clear();
+    }
+};
+
+#ifdef SIMPLE_LOGGER_POSIX
+
+/**
+ * Handlers of pthread_atfork() making sure no lock is held and no message is half-written while forking.
+ *
+ * The child process gets a new background thread with empty queues (in asynchronous mode).
+ */
+struct ForkHandlers {
+    static void prepare() {
+        AsyncBackend::prepareFork();
+        s_lockedRegistry = SinkRegistry::existing();
+        if (s_lockedRegistry != nullptr) {
+            s_lockedRegistry->lockForFork();
+        }
+        StreamLock *locks{streamLocks()};
+        for (std::size_t i = 0; i < streamLockCount; ++i) {
+            locks[i].mutex.lock();
+        }
+        // last, no other lock is ever taken while holding them
+        StatsRecorder::instance().lockForFork();
+        LatencyRecorder::instance().lockForFork();
+    }
+
+    static void parent() {
+        unlock();
+        AsyncBackend::resumeAfterFork();
+    }
+
+    static void child() {
+        SinkRegistry *registry{s_lockedRegistry};
+        unlock();
+        if (registry != nullptr) {
+            registry->resetAfterForkInChild();
+        }
+        AsyncBackend::resetAfterForkInChild();
+        if (!Config::forkInheritsFiles && registry != nullptr) {
+            std::string fileName;
+            {
+                SinkRegistry::Reader reader{*registry};
+                fileName = reader.snapshot().logFileName;
+            }
+            Sinks::setLogFile(fileName + '.' + std::to_string(getpid()));
+        }
+    }
+
+private:
+    static inline SinkRegistry *s_lockedRegistry{nullptr};
+
+    static void unlock() {
+        LatencyRecorder::instance().unlockAfterFork();
+        StatsRecorder::instance().unlockAfterFork();
+        StreamLock *locks{streamLocks()};
+        for (std::size_t i = streamLockCount; i > 0; --i) {
+            locks[i - 1].mutex.unlock();
+        }
+        if (s_lockedRegistry != nullptr) {
+            s_lockedRegistry->unlockAfterFork();
+            s_lockedRegistry = nullptr;
+        }
+    }
+};
+
+inline void registerForkHandlers() {
+    static const bool registered{pthread_atfork(&ForkHandlers::prepare, &ForkHandlers::parent,
+            &ForkHandlers::child) == 0};
+    static_cast<void>(registered);
+}
+
+/**
+ * Handlers of fatal signals writing pending asynchronous messages and a final message before the signal is re-raised.
+ *
+ * The handlers are async-signal-safe: messages are formatted into a buffer allocated beforehand without running user
+ * code (see formatRecordAfterCrash()), and only write(2) on a file opened beforehand is used for output.
+ * They run on an alternate signal stack (see prepareStack()), so that they can report a stack overflow as well.
+ */
+struct CrashHandlers {
+    static constexpr std::array<int, 5> signals{SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT};
+    // longer messages are truncated
+    static constexpr std::size_t scratchCapacity{64 * 1024};
+    static constexpr std::size_t alternateStackSize{64 * 1024};
+
+    static void install(const std::string &fileName) {
+        int file{::open(fileName.c_str(), O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0644)};
+        int previous{s_file.exchange(file)};
+        if (previous >= 0) {
+            ::close(previous);
+        }
+        std::lock_guard lock{s_installMutex};
+        if (!s_installed) {
+            s_scratch = new RecordBuffer();
+            s_scratch->reserve(scratchCapacity);
+            s_scratch->clear();
+            struct sigaction action{};
+            action.sa_handler = &handle;
+            // back to the default action on entry, so that crashing again inside the handler terminates the process
+            action.sa_flags = SA_ONSTACK | SA_RESETHAND;
+            sigemptyset(&action.sa_mask);
+            for (std::size_t i = 0; i < signals.size(); ++i) {
+                sigaction(signals[i], &action, &s_previousActions[i]);
+            }
+            s_installed.store(true, std::memory_order_release);
+        }
+        prepareStack();
+    }
+
+    /**
+     * Give the calling thread an alternate signal stack if the handlers are installed (and it has none yet).
+     *
+     * Called by the installing thread and by each thread logging for the first time (see threadHazard() and
+     * AsyncBackend::threadQueue()), the stack is freed when the thread exits.
+     */
+    static void prepareStack() {
+        if (s_installed.load(std::memory_order_acquire)) {
+            thread_local AlternateStack stack{};
+        }
+    }
+
+private:
+    class AlternateStack {
+    public:
+        AlternateStack() {
+            stack_t current{};
+            if (sigaltstack(nullptr, &current) != 0 || (current.ss_flags & SS_DISABLE) == 0) {
+                // keep a stack set up by someone else
+                return;
+            }
+            std::size_t size{std::max<std::size_t>(alternateStackSize, SIGSTKSZ)};
+            m_memory = new char[size];
+            stack_t stack{};
+            stack.ss_sp = m_memory;
+            stack.ss_size = size;
+            if (sigaltstack(&stack, nullptr) != 0) {
+                delete[] m_memory;
+                m_memory = nullptr;
+            }
+        }
+
+        AlternateStack(const AlternateStack &) = delete;
+        AlternateStack &operator=(const AlternateStack &) = delete;
+
+        ~AlternateStack() {
+            if (m_memory != nullptr) {
+                stack_t disabled{};
+                disabled.ss_flags = SS_DISABLE;
+                sigaltstack(&disabled, nullptr);
+                delete[] m_memory;
+            }
+        }
+
+    private:
+        char *m_memory{nullptr};
+    };
+
+    static inline std::atomic<int> s_file{-1};
+    static inline std::atomic<bool> s_handling{false};
+    static inline std::mutex s_installMutex;
+    static inline std::atomic<bool> s_installed{false};
+    static inline std::array<struct sigaction, signals.size()> s_previousActions{};
+    // never freed, it may be needed until the process ends
+    static inline RecordBuffer *s_scratch{nullptr};
+
+    static void handle(int signal) {
+        if (s_handling.exchange(true)) {
+            // another thread is already crashing, let it finish
+            while (true) {
+                ::pause();
+            }
+        }
+        Clock::time_point time{Clock::now()};
+        // stderr first, in case writing the pending messages crashes again
+        writeAll(STDERR_FILENO, crashMessage(signal, time));
+        int file{s_file.load()};
+        if (file >= 0) {
+            AsyncBackend::writePendingAfterCrash(*s_scratch, [file](std::string_view text) {
+                writeAll(file, text);
+            });
+            writeAll(file, crashMessage(signal, time));
+        }
+        // the signal is blocked until the handler returns, then it goes to the previous handler
+        for (std::size_t i = 0; i < signals.size(); ++i) {
+            if (signals[i] == signal) {
+                sigaction(signal, &s_previousActions[i], nullptr);
+            }
+        }
+        ::raise(signal);
+    }
+
+    static std::string_view crashMessage(int signal, Clock::time_point time) {
+        s_scratch->clear();
+        printPrefix(*s_scratch, LogLevel::Error, time, std::source_location::current());
+        s_scratch->append("crashed with signal ");
+        printInteger(*s_scratch, signal);
+        s_scratch->append('\n');
+        return s_scratch->view();
+    }
+
+    static void writeAll(int file, std::string_view text) {
+        while (!text.empty()) {
+            ssize_t written{::write(file, text.data(), text.size())};
+            if (written < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return;
+            }
+            text.remove_prefix(static_cast<std::size_t>(written));
+        }
+    }
+};
+
+inline void prepareCrashStack() {
+    CrashHandlers::prepareStack();
+}
+
+#else
+
+inline void registerForkHandlers() {
+}
+
+inline void prepareCrashStack() {
+}
+
+#endif
+
+} // detail
+
+namespace detail {
+
+SIMPLE_LOGGER_API void pushRecord(std::span<const std::byte> record) {
+    AsyncBackend::instance().push(record);
+}
+
+SIMPLE_LOGGER_API bool tryPushRecord(std::span<const std::byte> record) {
+    return AsyncBackend::instance().tryPush(record);
+}
+
+SIMPLE_LOGGER_API bool pushRecordAndResume(WaitingRecord &waiting) {
+    return AsyncBackend::instance().pushAndResume(waiting);
+}
+
+} // detail
+
+SIMPLE_LOGGER_API void flush() {
+    if constexpr (Config::asynchronous) {
+        detail::AsyncBackend::instance().flush();
+    }
+    if (detail::SinkRegistry *registry = detail::SinkRegistry::existing()) {
+        detail::SinkRegistry::Reader reader{*registry};
+        for (const auto &sinks : reader.snapshot().levels) {
+            for (const auto &sink : sinks) {
+                detail::timedFlush([&sink] { sink->flush(); });
+            }
+        }
+    }
+}
+
+SIMPLE_LOGGER_API bool shutdown(std::chrono::milliseconds timeout) {
+    if constexpr (Config::asynchronous) {
+        return detail::AsyncBackend::instance().stop(timeout);
+    } else {
+        return true;
+    }
+}
+
+SIMPLE_LOGGER_API void installCrashHandlers() {
+#ifdef SIMPLE_LOGGER_POSIX
+    std::string fileName;
+    {
+        detail::SinkRegistry::Reader reader{detail::SinkRegistry::instance()};
+        fileName = reader.snapshot().logFileName;
+    }
+    detail::CrashHandlers::install(fileName);
+#endif
+}
+
+SIMPLE_LOGGER_API void setCoroutineExecutor(CoroutineExecutor executor, void *context) {
+    detail::AsyncBackend::setExecutor(executor, context);
+}
+
+SIMPLE_LOGGER_API void logStats() {
+    Stats current{stats()};
+    Log<LogLevel::Info> log;
+    log << "Logger stats: messages";
+    for (std::size_t level = 0; level < logLevelCount; ++level) {
+        log << ' ' << logLevelToString(static_cast<LogLevel>(level)) << '=' << current.messages[level];
+    }
+    log << ", bytes " << std::accumulate(current.bytes.begin(), current.bytes.end(), std::uint64_t{0})
+        << ", dropped " << current.dropped
+        << ", queue full waits " << current.queueFullWaits
+        << ", queue high-watermark " << current.queueHighWatermark << " B"
+        << ", flushes " << current.flushDurations.count()
+        << " (p50 " << current.flushDurations.percentile(0.5).count()
+        << " ns, p99 " << current.flushDurations.percentile(0.99).count() << " ns)"
+        << ", writer busy " << std::chrono::duration_cast<std::chrono::milliseconds>(current.writerBusyTime).count()
+        << " ms";
+}
+
+} // simple_logger
+
+#endif
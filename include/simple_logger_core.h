@@ -0,0 +1,1176 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2024 Marek Zelený
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <iosfwd>
+#include <source_location>
+#include <cstring>
+#include <charconv>
+#include <concepts>
+#include <type_traits>
+#include <cstddef>
+#include <limits>
+#include <string_view>
+#include <utility>
+#include <new>
+#include <span>
+
+// <iosfwd> of libstdc++ and libc++ declares std::string as well, which is all this header needs
+#if !defined(__GLIBCXX__) && !defined(_LIBCPP_VERSION)
+#include <string>
+#endif
+
+/**
+ * This header only contains what log call sites need, so that it's cheap to include everywhere. The rest of the
+ * logger is in opt-in headers (all of them are included by simple_logger.h):
+ * - simple_logger_format.h: fixed(), hex(), range() and printing of containers, tuples and optionals
+ * - simple_logger_stats.h: the logger's statistics, latency histograms and call site profiling
+ * - simple_logger_coroutine.h: logging from coroutines (logAsync(), CO_LOG_* macros)
+ * Values printed to a log message's stream (operator<< for std::ostream) need <ostream> as well.
+ */
+
+/**
+ * Functions of the logger's backend (sinks, background thread, statistics) declared by this header are defined in
+ * simple_logger.h: inline by default, or compiled once into the simple_logger_compiled library when
+ * SIMPLE_LOGGER_COMPILED is defined (the library's CMake target defines it for its users).
+ */
+#ifdef SIMPLE_LOGGER_COMPILED
+#define SIMPLE_LOGGER_API
+#else
+#define SIMPLE_LOGGER_API inline
+#endif
+
+/**
+ * Keep code out of the log call sites (which are inlined into the calling functions): SIMPLE_LOGGER_NOINLINE for
+ * shared parts of each message, SIMPLE_LOGGER_COLD for rarely executed ones (e.g. growing a buffer).
+ *
+ * Backend functions using them are declared here without SIMPLE_LOGGER_API, their definitions add it: GCC only accepts
+ * the attributes on an inline function if its earlier declarations aren't inline.
+ */
+#if defined(__GNUC__)
+#define SIMPLE_LOGGER_NOINLINE [[gnu::noinline]]
+#define SIMPLE_LOGGER_COLD [[gnu::cold, gnu::noinline]]
+#elif defined(_MSC_VER)
+#define SIMPLE_LOGGER_NOINLINE __declspec(noinline)
+#define SIMPLE_LOGGER_COLD __declspec(noinline)
+#else
+#define SIMPLE_LOGGER_NOINLINE
+#define SIMPLE_LOGGER_COLD
+#endif
+
+#ifdef SIMPLE_LOGGER_STATEMENT_CATALOG
+#if !defined(__ELF__) || !defined(__GNUC__)
+#error "SIMPLE_LOGGER_STATEMENT_CATALOG requires an ELF target and GCC or Clang"
+#elif defined(__PIC__) && !defined(__PIE__)
+#error "SIMPLE_LOGGER_STATEMENT_CATALOG is only supported in executables (compiled without -fPIC, -fPIE is fine)"
+#endif
+#endif
+
+namespace simple_logger {
+
+enum class LogLevel : uint8_t {
+    Trace = 0,
+    Debug,
+    Info,
+    Warning,
+    Error,
+};
+
+inline constexpr std::size_t logLevelCount{5};
+
+inline constexpr const char *logLevelToString(LogLevel level) {
+    switch (level) {
+        case LogLevel::Trace: return "Trace";
+        case LogLevel::Debug: return "Debug";
+        case LogLevel::Info: return "Info";
+        case LogLevel::Warning: return "Warning";
+        case LogLevel::Error: return "Error";
+        default: return "Unknown";
+    }
+}
+
+/**
+ * Configuration class of the logger.
+ *
+ * Feel free to edit the constant values directly in this file, other values can be adjusted anywhere in code as needed.
+ */
+class Config {
+public:
+    /**
+     * Determines verbosity of the logger.
+     *
+     * Only logs with equal or higher level will be printed by the logger, lower-level logs will be ignored.
+     * The first value (if NDEBUG is set) is for RELEASE builds, the second value is for DEBUG builds.
+     * (NDEBUG is automatically set if the appropriate compiler flag is used, otherwise feel free to use any other macro
+     * available)
+     */
+#ifdef NDEBUG
+    static constexpr LogLevel logLevel{LogLevel::Info};
+#else
+    static constexpr LogLevel logLevel{LogLevel::Debug};
+#endif
+
+    /**
+     * If true, each log contains function signature, otherwise only file and line are logged.
+     */
+    static constexpr bool includeFunctionSignature{false};
+
+    /**
+     * If you need precise time information adjusted for timezone, use this variable to add/subtract hours.
+     */
+    static constexpr long timezoneAdjustment{0};
+
+    /**
+     * Maximum number of elements printed for containers and other ranges, the rest is replaced by a truncation marker.
+     *
+     * Can be adjusted for individual ranges using the range() helper.
+     */
+    static constexpr std::size_t maxRangeElements{100};
+
+    /**
+     * If true, log messages are written by a background thread, so that logging threads don't wait for any I/O.
+     *
+     * Arguments of log messages are copied by the logging thread and formatted by the background thread where possible
+     * (see Formatter for user types).
+     * Define SIMPLE_LOGGER_ASYNCHRONOUS (e.g. using a compiler flag) to enable it.
+     */
+#ifdef SIMPLE_LOGGER_ASYNCHRONOUS
+    static constexpr bool asynchronous{true};
+#else
+    static constexpr bool asynchronous{false};
+#endif
+
+    /**
+     * Size (in bytes, power of 2) of each logging thread's queue of messages waiting for the background thread.
+     *
+     * Logging blocks while the queue is full.
+     */
+    static constexpr std::size_t asyncBufferSize{1 << 20};
+
+    /**
+     * How often (in milliseconds) the background thread checks for new messages when idle.
+     */
+    static constexpr unsigned asyncPollMilliseconds{1};
+
+    /**
+     * Number of threads formatting asynchronous messages in parallel (0 to format them by the background thread).
+     *
+     * Useful if a single background thread can't keep up with formatting, the messages are still written in order by
+     * the background thread.
+     * Define SIMPLE_LOGGER_ASYNC_FORMATTER_THREADS as the number (e.g. using a compiler flag) to change it.
+     */
+#ifdef SIMPLE_LOGGER_ASYNC_FORMATTER_THREADS
+    static constexpr std::size_t asyncFormatterThreads{SIMPLE_LOGGER_ASYNC_FORMATTER_THREADS};
+#else
+    static constexpr std::size_t asyncFormatterThreads{0};
+#endif
+
+    /**
+     * If true, the duration of each log message (from creation of the Log object to writing or handing over the
+     * message) is recorded in per-level histograms, see logLatency().
+     *
+     * Define SIMPLE_LOGGER_MEASURE_LATENCY (e.g. using a compiler flag) to enable it.
+     */
+#ifdef SIMPLE_LOGGER_MEASURE_LATENCY
+    static constexpr bool measureLatency{true};
+#else
+    static constexpr bool measureLatency{false};
+#endif
+
+    /**
+     * Number of messages handed over to a formatter thread at once (see asyncFormatterThreads).
+     */
+    static constexpr std::size_t asyncBatchSize{256};
+
+    /**
+     * If true, a child process created by fork() keeps writing into the log file opened by the parent.
+     *
+     * Otherwise, the child reopens the log file with its process ID appended to the name (e.g. "Info.log.1234").
+     */
+    static constexpr bool forkInheritsFiles{true};
+
+    /**
+     * If true, the logger counts its own work (messages, bytes, flushes, ...), see stats().
+     */
+    static constexpr bool collectStats{true};
+
+    /**
+     * How often (in seconds) the background thread logs the logger's statistics (see logStats()), zero to never.
+     *
+     * Only used in asynchronous mode, call logStats() periodically yourself in synchronous mode.
+     */
+    static constexpr unsigned statsIntervalSeconds{0};
+
+    /**
+     * If true, the convenience macros count messages and bytes written by each call site, see noisiestCallSites().
+     *
+     * Define SIMPLE_LOGGER_PROFILE_CALL_SITES (e.g. using a compiler flag) to enable it.
+     */
+#ifdef SIMPLE_LOGGER_PROFILE_CALL_SITES
+    static constexpr bool profileCallSites{true};
+#else
+    static constexpr bool profileCallSites{false};
+#endif
+
+    /**
+     * If true, the convenience macros list every active log statement in the simple_logger_statements section of the
+     * executable, see logStatements().
+     *
+     * Define SIMPLE_LOGGER_STATEMENT_CATALOG (e.g. using a compiler flag) to enable it. ELF executables only.
+     */
+#ifdef SIMPLE_LOGGER_STATEMENT_CATALOG
+    static constexpr bool statementCatalog{true};
+#else
+    static constexpr bool statementCatalog{false};
+#endif
+
+    /**
+     * If logging to file is used, set this variable to the desired log file path/name.
+     *
+     * Changes only take effect before the first log message, use Sinks::setLogFile() afterwards.
+     * Defined by the backend as the name of the log level followed by ".log" (include <string> to change it).
+     */
+    static std::string logFileName;
+
+    /**
+     * Placeholder for the log file in defaultOutput().
+     */
+    static constexpr std::ostream *logFile{nullptr};
+
+    /**
+     * Standard output (std::cout) for defaultOutput(), defined by the backend so that this header doesn't need
+     * <iostream>.
+     */
+    SIMPLE_LOGGER_API static std::ostream *standardOutput();
+
+    /**
+     * Determines the default stream for each log level where output will be printed (the initial sinks of the level).
+     *
+     * Adjust the return values for individual levels to use desired output streams (logFile for the log file).
+     * The outputs can be changed at runtime using the Sinks class.
+     */
+    template<LogLevel Level>
+    static std::ostream *defaultOutput() {
+        if constexpr (Level == LogLevel::Debug) {
+            return logFile;
+        } else if constexpr (Level == LogLevel::Info) {
+            return logFile;
+        } else if constexpr (Level == LogLevel::Warning) {
+            return logFile;
+        } else if constexpr (Level == LogLevel::Error) {
+            return logFile;
+        } else {
+            return standardOutput();
+        }
+    }
+
+    /**
+     * Default stream of a log level (see defaultOutput()), the current log file is opened if needed.
+     *
+     * The log file's stream always writes into the current log file, even after Sinks::setLogFile().
+     */
+    template<LogLevel Level>
+    static std::ostream &getDefaultStream() {
+        std::ostream *stream{defaultOutput<Level>()};
+        return stream == logFile ? currentLogFile() : *stream;
+    }
+
+    /**
+     * The current log file, opened if needed.
+     *
+     * The stream stays valid until exit, but messages are no longer written into it once the log file is changed.
+     * The file is therefore kept open until exit as well, even after Sinks::setLogFile() (each file returned leaks).
+     * @deprecated Messages are written through sinks, use Sinks::logFile() (or Sinks::setLogFile() to change the file).
+     */
+    [[deprecated("use Sinks::logFile()")]] SIMPLE_LOGGER_API static std::ofstream &getLogFile();
+
+private:
+    SIMPLE_LOGGER_API static std::ostream &currentLogFile();
+};
+
+/**
+ * Compile-time log level of a part of the program (a module), overriding Config::logLevel for its log messages.
+ *
+ * Any type with a `static constexpr LogLevel logLevel` member can be used as the Module parameter of Log, e.g. to
+ * compile out debug messages of a chatty library while keeping them in the rest of the program.
+ * The macros use SIMPLE_LOGGER_MODULE (see SIMPLE_LOGGER_MODULE_LEVEL).
+ */
+template<LogLevel Level>
+struct ModuleLevel {
+    static constexpr LogLevel logLevel{Level};
+};
+
+/**
+ * Module of log messages not specifying any, using Config::logLevel.
+ */
+using DefaultModule = ModuleLevel<Config::logLevel>;
+
+/**
+ * Kinds of values printed by the record buffer's fast paths, see RecordBuffer::hasDefaultFormat().
+ */
+enum class FormatKind : uint8_t {
+    // characters and strings (only affected by the field width)
+    Text,
+    Boolean,
+    Integer,
+    Floating,
+};
+
+/**
+ * Character buffer collecting a single log record before it's written to the output stream.
+ *
+ * Short records fit into the inline storage, longer ones spill over to the heap.
+ * Anything printable to std::ostream can be written into it via stream(), which is defined by the backend (together
+ * with the stream) so that this header doesn't need <ostream>.
+ */
+class RecordBuffer {
+public:
+    static constexpr std::size_t inlineCapacity{512};
+
+    /**
+     * Space reserved for the stream, a stream which doesn't fit (depending on the standard library) is allocated.
+     */
+    static constexpr std::size_t streamCapacity{384};
+
+    RecordBuffer() = default;
+
+    RecordBuffer(const RecordBuffer &) = delete;
+    RecordBuffer &operator=(const RecordBuffer &) = delete;
+
+    ~RecordBuffer() {
+        if (m_stream != nullptr) {
+            closeStream();
+        }
+        delete[] m_heap;
+    }
+
+    char *data() {
+        return m_begin;
+    }
+
+    const char *data() const {
+        return m_begin;
+    }
+
+    std::size_t size() const {
+        return m_end - m_begin;
+    }
+
+    std::string_view view() const {
+        return {data(), size()};
+    }
+
+    /**
+     * Number of characters which can be written without growing the buffer.
+     */
+    std::size_t available() const {
+        return m_capacityEnd - m_end;
+    }
+
+    void append(char character) {
+        reserve(1)[0] = character;
+        ++m_end;
+    }
+
+    void append(std::string_view text) {
+        std::memcpy(reserve(text.size()), text.data(), text.size());
+        commit(text.size());
+    }
+
+    /**
+     * Get a pointer where at least `count` characters can be written, then call commit() with the number written.
+     */
+    char *reserve(std::size_t count) {
+        if (available() < count) {
+            grow(size() + count);
+        }
+        return m_end;
+    }
+
+    void commit(std::size_t count) {
+        m_end += count;
+    }
+
+    void clear() {
+        m_end = m_begin;
+        if (m_stream != nullptr) {
+            closeStream();
+        }
+    }
+
+    /**
+     * Stream writing into the buffer, created on first use (most records never need it).
+     *
+     * Its formatting state (manipulators) applies only to the current record.
+     */
+    SIMPLE_LOGGER_API std::ostream &stream();
+
+    /**
+     * Checks that no manipulators affecting given kind of values (or width) were applied to the buffer's stream.
+     *
+     * Fast paths writing directly into the buffer must fall back to the stream otherwise.
+     */
+    bool hasDefaultFormat(FormatKind kind) const {
+        return m_stream == nullptr || streamHasDefaultFormat(kind);
+    }
+
+    bool hasStream() const {
+        return m_stream != nullptr;
+    }
+
+    /**
+     * Print any loggable value into the buffer (useful for implementing formatters of composite types).
+     */
+    template<typename T>
+    RecordBuffer &operator<<(const T &token);
+
+private:
+    char m_inline[inlineCapacity];
+    char *m_begin{m_inline};
+    char *m_end{m_inline};
+    char *m_capacityEnd{m_inline + inlineCapacity};
+    char *m_heap{nullptr};
+    std::ostream *m_stream{nullptr};
+    alignas(std::max_align_t) std::byte m_streamStorage[streamCapacity];
+
+    SIMPLE_LOGGER_API bool streamHasDefaultFormat(FormatKind kind) const;
+
+    SIMPLE_LOGGER_API void closeStream();
+
+    SIMPLE_LOGGER_COLD void grow(std::size_t required) {
+        std::size_t used{size()};
+        std::size_t capacity{2 * static_cast<std::size_t>(m_capacityEnd - m_begin)};
+        capacity = capacity < required ? required : capacity;
+        char *heap{new char[capacity]};
+        std::memcpy(heap, m_begin, used);
+        delete[] m_heap;
+        m_heap = heap;
+        m_begin = heap;
+        m_end = heap + used;
+        m_capacityEnd = heap + capacity;
+    }
+};
+
+/**
+ * Customization point for printing user types directly into the record buffer, without going through std::ostream.
+ *
+ * Specialize it with a static function `void format(const T &value, RecordBuffer &buffer)`.
+ * The logger prefers the formatter over operator<< for std::ostream if both are available.
+ */
+template<typename T>
+struct Formatter;
+
+template<typename T>
+concept HasFormatter = requires(const T &value, RecordBuffer &buffer) {
+    Formatter<T>::format(value, buffer);
+};
+
+namespace detail {
+
+/**
+ * Fallback of printFloat() for values too long for its buffer.
+ */
+void printFloatWithStream(RecordBuffer &buffer, long double value, std::chars_format format, int precision);
+
+/**
+ * Fast floating point printing bypassing the stream's locale-aware number formatting.
+ *
+ * Without explicit format, the shortest representation that parses back to the same value is printed.
+ * Values that don't fit into the reserved space (only possible with huge fixed-point values) fall back to the stream.
+ * Shared by all call sites like printInteger().
+ */
+template<std::floating_point T>
+SIMPLE_LOGGER_NOINLINE void printFloat(
+        RecordBuffer &buffer, T value, std::chars_format format = std::chars_format{}, int precision = -1) {
+    constexpr std::size_t maxLength{64};
+    char *start{buffer.reserve(maxLength)};
+    std::to_chars_result result = format == std::chars_format{}
+            ? std::to_chars(start, start + maxLength, value)
+            : std::to_chars(start, start + maxLength, value, format, precision);
+    if (result.ec == std::errc{}) {
+        buffer.commit(result.ptr - start);
+        return;
+    }
+    printFloatWithStream(buffer, value, format, precision);
+}
+
+/**
+ * Print an integer, shared by all call sites (inlining std::to_chars into each of them would add a lot of code).
+ */
+template<std::integral T>
+SIMPLE_LOGGER_NOINLINE void printInteger(RecordBuffer &buffer, T value) {
+    constexpr std::size_t maxLength{std::numeric_limits<T>::digits10 + 2};
+    char *start{buffer.reserve(maxLength)};
+    buffer.commit(std::to_chars(start, start + maxLength, value).ptr - start);
+}
+
+template<typename T>
+inline constexpr bool isCharacter{std::is_same_v<T, char> || std::is_same_v<T, signed char>
+        || std::is_same_v<T, unsigned char> || std::is_same_v<T, wchar_t> || std::is_same_v<T, char8_t>
+        || std::is_same_v<T, char16_t> || std::is_same_v<T, char32_t>};
+
+template<typename T>
+void print(RecordBuffer &buffer, const T &token);
+
+/**
+ * Print a value of a built-in type using the buffer's stream (if manipulators were applied to it), defined by the
+ * backend.
+ */
+void printWithStream(RecordBuffer &buffer, char token);
+void printWithStream(RecordBuffer &buffer, bool token);
+void printWithStream(RecordBuffer &buffer, short token);
+void printWithStream(RecordBuffer &buffer, unsigned short token);
+void printWithStream(RecordBuffer &buffer, int token);
+void printWithStream(RecordBuffer &buffer, unsigned int token);
+void printWithStream(RecordBuffer &buffer, long token);
+void printWithStream(RecordBuffer &buffer, unsigned long token);
+void printWithStream(RecordBuffer &buffer, long long token);
+void printWithStream(RecordBuffer &buffer, unsigned long long token);
+void printWithStream(RecordBuffer &buffer, float token);
+void printWithStream(RecordBuffer &buffer, double token);
+void printWithStream(RecordBuffer &buffer, long double token);
+void printWithStream(RecordBuffer &buffer, const char *token);
+void printWithStream(RecordBuffer &buffer, std::string_view token);
+
+/**
+ * Print a value of any other type using the buffer's stream, kept out of line as it expands to a lot of code.
+ */
+template<typename T>
+SIMPLE_LOGGER_NOINLINE void printStreamable(RecordBuffer &buffer, const T &token) {
+    buffer.stream() << token;
+}
+
+/**
+ * True if the type has operator<< for std::ostream (always false without <ostream>).
+ */
+template<typename T>
+concept Streamable = requires(std::ostream &stream, const T &value) {
+    stream << value;
+};
+
+/**
+ * Printing of containers, tuples and optionals, defined by simple_logger_format.h.
+ */
+template<typename T>
+struct CompositePrinter;
+
+template<typename T>
+concept PrintableComposite = requires(RecordBuffer &buffer, const T &value) {
+    CompositePrinter<T>::print(buffer, value);
+};
+
+/**
+ * Print a token into the record buffer.
+ *
+ * Types with a Formatter and common types are written directly into the buffer, anything else (or tokens affected by
+ * manipulators applied by the user) goes through the buffer's stream.
+ * Containers, tuples and optionals are formatted element by element unless they define their own stream operator.
+ */
+template<typename T>
+void print(RecordBuffer &buffer, const T &token) {
+    if constexpr (HasFormatter<T>) {
+        Formatter<T>::format(token, buffer);
+    } else if constexpr (std::is_same_v<T, char>) {
+        if (buffer.hasDefaultFormat(FormatKind::Text)) {
+            buffer.append(token);
+        } else {
+            printWithStream(buffer, token);
+        }
+    } else if constexpr (std::is_same_v<T, bool>) {
+        if (buffer.hasDefaultFormat(FormatKind::Boolean)) {
+            buffer.append(token ? '1' : '0');
+        } else {
+            printWithStream(buffer, token);
+        }
+    } else if constexpr (std::is_floating_point_v<T>) {
+        if (buffer.hasDefaultFormat(FormatKind::Floating)) {
+            printFloat(buffer, token);
+        } else {
+            printWithStream(buffer, token);
+        }
+    } else if constexpr (std::is_integral_v<T> && !isCharacter<T>) {
+        if (buffer.hasDefaultFormat(FormatKind::Integer)) {
+            printInteger(buffer, token);
+        } else {
+            printWithStream(buffer, token);
+        }
+    } else if constexpr (std::is_same_v<T, const char *> || std::is_same_v<T, char *>) {
+        if (buffer.hasDefaultFormat(FormatKind::Text)) {
+            // printing null pointer to the stream would put it in a failed state
+            buffer.append(token != nullptr ? std::string_view(token) : std::string_view("(null)"));
+        } else {
+            printWithStream(buffer, static_cast<const char *>(token));
+        }
+    } else if constexpr (std::is_convertible_v<const T &, std::string_view>) {
+        if (buffer.hasDefaultFormat(FormatKind::Text)) {
+            buffer.append(std::string_view(token));
+        } else {
+            printWithStream(buffer, std::string_view(token));
+        }
+    } else if constexpr (Streamable<T>) {
+        printStreamable(buffer, token);
+    } else {
+        static_assert(PrintableComposite<T>, "Type can't be printed, define operator<< for std::ostream (and include "
+                "<ostream>) or a Formatter, containers, tuples and optionals need simple_logger_format.h");
+        CompositePrinter<T>::print(buffer, token);
+    }
+}
+
+} // detail
+
+template<typename T>
+RecordBuffer &RecordBuffer::operator<<(const T &token) {
+    detail::print(*this, token);
+    return *this;
+}
+
+namespace detail {
+
+#if !defined(__x86_64__) && !defined(__i386__)
+/**
+ * Nanoseconds of the steady clock, defined by the backend so that this header doesn't need <chrono>.
+ */
+SIMPLE_LOGGER_API std::uint64_t steadyTicks();
+#endif
+
+/**
+ * Cheap timestamp for measuring short durations (CPU timestamp counter where available, nanoseconds otherwise).
+ */
+inline std::uint64_t readTicks() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __builtin_ia32_rdtsc();
+#else
+    return steadyTicks();
+#endif
+}
+
+class CallSite;
+
+} // detail
+
+/**
+ * Log statement (expansion of a convenience macro) listed in the statement catalog, see logStatements().
+ */
+struct LogStatement {
+    const char *file;
+    const char *function;
+    // source text of the arguments of CO_LOG_* macros, empty for the stream chains of the other macros
+    const char *arguments;
+    std::uint_least32_t line;
+    LogLevel level;
+};
+
+namespace detail {
+#ifdef SIMPLE_LOGGER_STATEMENT_CATALOG
+extern "C" [[gnu::weak]] const LogStatement *const __start_simple_logger_statements[];
+extern "C" [[gnu::weak]] const LogStatement *const __stop_simple_logger_statements[];
+
+/**
+ * Never called, instantiating it adds a pointer to the statement to the catalog section.
+ *
+ * The pointer is emitted in the section group of this function, so the linker keeps a single copy of statements in
+ * inline functions and templates used by several translation units (unlike a section attribute on the statement).
+ */
+template<const LogStatement *Statement>
+[[gnu::used]] void addToCatalog() {
+    asm(".pushsection simple_logger_statements, \"aw?\"\n.balign 8\n.dc.a %c0\n.popsection" : : "i"(Statement));
+}
+#endif
+
+/**
+ * Add an active statement to the catalog (used by the convenience macros, always true).
+ */
+template<const LogStatement *Statement, bool Active>
+consteval bool catalogued() {
+#ifdef SIMPLE_LOGGER_STATEMENT_CATALOG
+    if constexpr (Active) {
+        static_cast<void>(&addToCatalog<Statement>);
+    }
+#endif
+    return true;
+}
+} // detail
+
+namespace detail {
+
+/**
+ * Write a whole message into a stream and flush it (like std::endl) under the stream's lock.
+ */
+SIMPLE_LOGGER_API void writeLocked(std::ostream &stream, std::string_view text, bool flush);
+
+/**
+ * Flush a stream under its lock (see writeLocked()).
+ */
+SIMPLE_LOGGER_API void flushLocked(std::ostream &stream);
+
+/**
+ * Stream discarding everything written into it (the stream of inactive log messages).
+ */
+SIMPLE_LOGGER_API std::ostream &nullStream();
+
+} // detail
+
+namespace detail {
+
+/**
+ * Start a synchronous log message with its prefix, e.g. "[16:44:24.078][Info][example.cpp:6] " (shared by all call
+ * sites instead of inlined into each of them).
+ */
+void beginRecord(RecordBuffer &buffer, LogLevel level, const std::source_location &location);
+
+/**
+ * Start an asynchronous log message with its header (the time, location and destination of the message).
+ */
+void beginCapture(RecordBuffer &buffer, LogLevel level, std::ostream *stream, const std::source_location &location,
+        CallSite *site);
+
+/**
+ * Function printing an argument captured by an asynchronous log message.
+ */
+using PrintCaptured = void (*)(const std::byte *data, std::size_t size, RecordBuffer &buffer);
+
+/**
+ * Header of each argument captured by an asynchronous log message, followed by `size` bytes of data.
+ */
+struct CapturedArgument {
+    PrintCaptured print;
+    std::size_t size;
+};
+
+/**
+ * Bytes captured by an asynchronous log message instead of formatting the argument they belong to right away.
+ *
+ * A Formatter may provide `static CapturedBytes capture(const T &value)` for types referring to binary data (like
+ * hex()), the bytes are then copied into the message and printed by the background thread.
+ */
+struct CapturedBytes {
+    PrintCaptured print;
+    const void *data;
+    std::size_t size;
+};
+
+template<typename T>
+concept CapturesBytes = requires(const T &value) {
+    { Formatter<T>::capture(value) } -> std::same_as<CapturedBytes>;
+};
+
+inline void printCapturedText(const std::byte *data, std::size_t size, RecordBuffer &buffer) {
+    buffer.append(std::string_view(reinterpret_cast<const char *>(data), size));
+}
+
+template<typename T>
+void printCapturedValue(const std::byte *data, std::size_t, RecordBuffer &buffer) {
+    alignas(T) std::byte storage[sizeof(T)];
+    std::memcpy(storage, data, sizeof(T));
+    print(buffer, *std::launder(reinterpret_cast<const T *>(storage)));
+}
+
+template<typename T>
+consteval bool formatterAllowsDeferral() {
+    if constexpr (requires { Formatter<T>::deferred; }) {
+        return Formatter<T>::deferred;
+    } else {
+        return false;
+    }
+}
+
+/**
+ * Types formatted by the background thread in asynchronous mode: the value is copied into the message as it is.
+ *
+ * Besides arithmetic types, this applies to trivially copyable types whose Formatter opts in with
+ * `static constexpr bool deferred{true}`, which it may only do if the type doesn't refer to memory that may not
+ * outlive the log message (e.g. through a pointer, a string_view or a span).
+ */
+template<typename T>
+concept Deferrable = std::is_trivially_copyable_v<T> && (HasFormatter<T> ? formatterAllowsDeferral<T>()
+        : std::is_arithmetic_v<T> && (!isCharacter<T> || std::is_same_v<T, char>));
+
+/**
+ * Asynchronous log message under construction, capturing arguments for the background thread.
+ *
+ * Deferrable arguments are copied as they are and strings as text, anything else is formatted right away.
+ * Once the message's stream is used, the rest of the message is formatted right away as well, so that manipulators
+ * apply to it.
+ */
+class RecordCapture {
+public:
+    void begin(LogLevel level, std::ostream *stream, const std::source_location &location, CallSite *site = nullptr) {
+        beginCapture(m_buffer, level, stream, location, site);
+    }
+
+    template<typename T>
+    void capture(const T &token) {
+        if (!m_buffer.hasStream()) {
+            if constexpr (Deferrable<T>) {
+                captureArgument(&printCapturedValue<T>, &token, sizeof(T));
+                return;
+            } else if constexpr (CapturesBytes<T>) {
+                CapturedBytes bytes{Formatter<T>::capture(token)};
+                captureArgument(bytes.print, bytes.data, bytes.size);
+                return;
+            }
+        }
+        openText();
+        print(m_buffer, token);
+    }
+
+    std::ostream &stream() {
+        openText();
+        return m_buffer.stream();
+    }
+
+    /**
+     * Finish the message, returning its captured representation.
+     */
+    std::span<const std::byte> finish() {
+        closeText();
+        return {reinterpret_cast<const std::byte *>(m_buffer.data()), m_buffer.size()};
+    }
+
+private:
+    static constexpr std::size_t noText{std::numeric_limits<std::size_t>::max()};
+
+    RecordBuffer m_buffer;
+    std::size_t m_textArgument{noText};
+
+    void openText() {
+        if (m_textArgument == noText) {
+            m_textArgument = m_buffer.size();
+            CapturedArgument argument{&printCapturedText, 0};
+            append(&argument, sizeof(argument));
+        }
+    }
+
+    void closeText() {
+        if (m_textArgument != noText) {
+            std::size_t size{m_buffer.size() - m_textArgument - sizeof(CapturedArgument)};
+            std::memcpy(m_buffer.data() + m_textArgument + offsetof(CapturedArgument, size), &size, sizeof(size));
+            m_textArgument = noText;
+        }
+    }
+
+    void captureArgument(PrintCaptured print, const void *data, std::size_t size) {
+        closeText();
+        CapturedArgument argument{print, size};
+        append(&argument, sizeof(argument));
+        append(data, size);
+    }
+
+    void append(const void *data, std::size_t size) {
+        m_buffer.append(std::string_view(static_cast<const char *>(data), size));
+    }
+};
+
+/**
+ * Write a log message to all sinks of its level.
+ */
+SIMPLE_LOGGER_API void writeToSinks(LogLevel level, std::string_view text);
+
+/**
+ * Format a captured log message and write it right away on the calling thread, flushing its stream.
+ */
+SIMPLE_LOGGER_API void writeRecord(std::span<const std::byte> record);
+
+/**
+ * Count a written log message in the logger's statistics (see stats()).
+ */
+SIMPLE_LOGGER_API void countMessage(LogLevel level, std::size_t bytes);
+
+/**
+ * Record the duration of a log message (see logLatency()).
+ */
+SIMPLE_LOGGER_API void recordLatency(LogLevel level, std::uint64_t ticks);
+
+/**
+ * Hand a captured message over to the background thread, blocking while the thread's queue is full.
+ */
+SIMPLE_LOGGER_API void pushRecord(std::span<const std::byte> record);
+
+} // detail
+
+/**
+ * Log class intended to be used as a temporary object for each log message.
+ *
+ * You can either use this class directly, or use the convenience macros defined later for less verbose usage.
+ * @tparam Level Verbosity level of the log message (the message will be ignored if the module's log level is higher)
+ * @tparam Module Part of the program the message belongs to, its log level replaces Config's one (see ModuleLevel)
+ */
+template<LogLevel Level, typename Module = DefaultModule>
+class Log {
+public:
+    static constexpr bool isActive{Level >= Module::logLevel};
+
+    /**
+     * Log message written to the sinks of its level (see Sinks and Config::defaultOutput()).
+     */
+    explicit Log(const std::source_location location = std::source_location::current()) :
+            Log(nullptr, location) {
+    }
+
+    /**
+     * Log message written to a custom stream.
+     *
+     * The message is written (and the stream flushed) before the destructor returns, in asynchronous mode as well,
+     * so the stream only has to outlive the Log object. It's not ordered with messages still waiting for the background
+     * thread then (e.g. if the stream is also used by a sink).
+     */
+    explicit Log(std::ostream &stream, const std::source_location location = std::source_location::current()) :
+            Log(&stream, location) {
+    }
+
+    /**
+     * Log message counted in the statistics of a call site (used by the convenience macros).
+     */
+    explicit Log(detail::CallSite &site, const std::source_location location = std::source_location::current()) :
+            Log(nullptr, location, &site) {
+    }
+
+    /**
+     * Write the whole message (terminated by a newline) to the stream and flush it.
+     *
+     * In asynchronous mode, the message is handed over to the background thread instead (unless it's written to a
+     * custom stream).
+     */
+    ~Log() {
+        if constexpr (isActive) {
+            if constexpr (Config::asynchronous) {
+                if (m_stream != nullptr) {
+                    detail::writeRecord(m_message.finish());
+                } else {
+                    detail::pushRecord(m_message.finish());
+                }
+            } else {
+                m_message.append('\n');
+                detail::countMessage(Level, m_message.size());
+                if constexpr (Config::profileCallSites) {
+                    if (m_site != nullptr) {
+                        m_site->add(m_message.size());
+                    }
+                }
+                if (m_stream != nullptr) {
+                    detail::writeLocked(*m_stream, m_message.view(), true);
+                } else {
+                    detail::writeToSinks(Level, m_message.view());
+                }
+            }
+            if constexpr (Config::measureLatency) {
+                detail::recordLatency(Level, detail::readTicks() - m_startTicks);
+            }
+        }
+    }
+
+    /**
+     * Get a stream writing into this log message (e.g. to pass it to functions printing to std::ostream).
+     */
+    std::ostream &getStream() {
+        if constexpr (isActive) {
+            return m_message.stream();
+        } else {
+            return detail::nullStream();
+        }
+    }
+
+    template<typename T>
+    Log &operator<<(const T &token) {
+        if constexpr (isActive) {
+            if constexpr (Config::asynchronous) {
+                m_message.capture(token);
+            } else {
+                detail::print(m_message, token);
+            }
+        }
+        return *this;
+    }
+
+private:
+    struct Inactive {};
+    using Message = std::conditional_t<Config::asynchronous, detail::RecordCapture, RecordBuffer>;
+
+    [[no_unique_address]] std::conditional_t<isActive && Config::measureLatency, std::uint64_t, Inactive> m_startTicks;
+    std::ostream *m_stream;
+    [[no_unique_address]] std::conditional_t<isActive && Config::profileCallSites && !Config::asynchronous,
+            detail::CallSite *, Inactive> m_site;
+    [[no_unique_address]] std::conditional_t<isActive, Message, Inactive> m_message;
+
+    Log(std::ostream *stream, const std::source_location &location, detail::CallSite *site = nullptr) :
+            m_stream(stream) {
+        if constexpr (isActive && Config::measureLatency) {
+            m_startTicks = detail::readTicks();
+        }
+        if constexpr (isActive && Config::profileCallSites && !Config::asynchronous) {
+            m_site = site;
+        }
+        if constexpr (isActive) {
+            if constexpr (Config::asynchronous) {
+                m_message.begin(Level, stream, location, site);
+            } else {
+                detail::beginRecord(m_message, Level, location);
+            }
+        }
+    }
+};
+
+} // simple_logger
+
+/**
+ * Comment out this definition to disable convenience macros if you don't like them.
+ */
+#define SIMPLE_LOGGER_ENABLE_MACROS
+
+#ifdef SIMPLE_LOGGER_ENABLE_MACROS
+
+/**
+ * Module of the macros' log messages (see ModuleLevel), determined when this header is first included.
+ *
+ * To override Config::logLevel in a translation unit (or a library), define SIMPLE_LOGGER_MODULE_LEVEL before
+ * including the header, e.g. `#define SIMPLE_LOGGER_MODULE_LEVEL Warning`. Messages below that level are compiled out
+ * completely, and it can also enable levels disabled by Config (e.g. Trace).
+ * Alternatively, define SIMPLE_LOGGER_MODULE as your own module type.
+ *
+ * Only messages in non-inline functions of the translation unit get its level: inline functions and templates from
+ * headers shared with translation units using another level violate the ODR, the linker keeps one of their definitions.
+ */
+#ifndef SIMPLE_LOGGER_MODULE
+#ifdef SIMPLE_LOGGER_MODULE_LEVEL
+#define SIMPLE_LOGGER_MODULE simple_logger::ModuleLevel<simple_logger::LogLevel::SIMPLE_LOGGER_MODULE_LEVEL>
+#else
+#define SIMPLE_LOGGER_MODULE simple_logger::DefaultModule
+#endif
+#endif
+
+/**
+ * Log message on a given level to default output stream with a single stream chain.
+ */
+#define SIMPLE_LOGGER_LOG(level) \
+    if constexpr(simple_logger::Log<simple_logger::LogLevel::level, SIMPLE_LOGGER_MODULE>::isActive) \
+        SIMPLE_LOGGER_STATEMENT(level, "", (simple_logger::Log<simple_logger::LogLevel::level, \
+                SIMPLE_LOGGER_MODULE>::isActive)) \
+        simple_logger::Log<simple_logger::LogLevel::level, SIMPLE_LOGGER_MODULE>(SIMPLE_LOGGER_CALL_SITE(level))
+
+/**
+ * Statement descriptor of a macro expansion added to the catalog (see Config::statementCatalog), either as the init
+ * statement of an if (SIMPLE_LOGGER_STATEMENT) or as a declaration (SIMPLE_LOGGER_STATEMENT_DECLARATION).
+ *
+ * Statements are added only if active, a discarded if constexpr branch is still instantiated outside templates.
+ */
+#ifdef SIMPLE_LOGGER_STATEMENT_CATALOG
+#define SIMPLE_LOGGER_STATEMENT_DESCRIPTOR(level, arguments) \
+    static constexpr simple_logger::LogStatement _sl_statement{std::source_location::current().file_name(), \
+            std::source_location::current().function_name(), arguments, std::source_location::current().line(), \
+            simple_logger::LogLevel::level}
+#define SIMPLE_LOGGER_STATEMENT(level, arguments, active) \
+    if constexpr(SIMPLE_LOGGER_STATEMENT_DESCRIPTOR(level, arguments); \
+            simple_logger::detail::catalogued<&_sl_statement, active>())
+#define SIMPLE_LOGGER_STATEMENT_DECLARATION(level, active) \
+    SIMPLE_LOGGER_STATEMENT_DESCRIPTOR(level, ""); \
+    static_assert(simple_logger::detail::catalogued<&_sl_statement, active>());
+#else
+#define SIMPLE_LOGGER_STATEMENT(level, arguments, active)
+#define SIMPLE_LOGGER_STATEMENT_DECLARATION(level, active)
+#endif
+
+/**
+ * Counters of the line using a macro (see Config::profileCallSites), a static variable created for each expansion.
+ */
+#ifdef SIMPLE_LOGGER_PROFILE_CALL_SITES
+#define SIMPLE_LOGGER_CALL_SITE(level) []() -> simple_logger::detail::CallSite & { \
+        static simple_logger::detail::CallSite site{simple_logger::LogLevel::level}; \
+        return site; \
+    }()
+#else
+#define SIMPLE_LOGGER_CALL_SITE(level)
+#endif
+
+/**
+ * Log a trace message with a single stream chain.
+ */
+#define LOG_TRACE SIMPLE_LOGGER_LOG(Trace)
+
+/**
+ * Log a debug message with a single stream chain.
+ */
+#define LOG_DEBUG SIMPLE_LOGGER_LOG(Debug)
+
+/**
+ * Log an info message with a single stream chain.
+ */
+#define LOG_INFO SIMPLE_LOGGER_LOG(Info)
+
+/**
+ * Log a warning message with a single stream chain.
+ */
+#define LOG_WARNING SIMPLE_LOGGER_LOG(Warning)
+
+/**
+ * Log an error message with a single stream chain.
+ */
+#define LOG_ERROR SIMPLE_LOGGER_LOG(Error)
+
+/**
+ * Create a local instance of a log on a given level and get the logger's default stream as a variable of given name.
+ *
+ * Use this macro (or derived macros) for more detailed log message control, e.g. giving the stream as a function
+ * argument.
+ */
+#define GET_LOG_STREAM(level, name) \
+    SIMPLE_LOGGER_STATEMENT_DECLARATION(level, (simple_logger::Log<simple_logger::LogLevel::level, \
+            SIMPLE_LOGGER_MODULE>::isActive)) \
+    simple_logger::Log<simple_logger::LogLevel::level, SIMPLE_LOGGER_MODULE> _sl_log{SIMPLE_LOGGER_CALL_SITE(level)}; \
+    std::ostream &name = _sl_log.getStream()
+
+/**
+ * Create a local instance of a debug log and get the logger's default stream as a variable of given name.
+ */
+#define GET_LOG_STREAM_TRACE(name) GET_LOG_STREAM(Trace, name)
+
+/**
+ * Create a local instance of a debug log and get the logger's default stream as a variable of given name.
+ */
+#define GET_LOG_STREAM_DEBUG(name) GET_LOG_STREAM(Debug, name)
+
+/**
+ * Create a local instance of an info log and get the logger's default stream as a variable of given name.
+ */
+#define GET_LOG_STREAM_INFO(name) GET_LOG_STREAM(Info, name)
+
+/**
+ * Create a local instance of a warning log and get the logger's default stream as a variable of given name.
+ */
+#define GET_LOG_STREAM_WARNING(name) GET_LOG_STREAM(Warning, name)
+
+/**
+ * Create a local instance of an error log and get the logger's default stream as a variable of given name.
+ */
+#define GET_LOG_STREAM_ERROR(name) GET_LOG_STREAM(Error, name)
+
+#endif // SIMPLE_LOGGER_ENABLE_MACROS
+
+/**
+ * Profiled call sites (see Config::profileCallSites) count their messages using the definition of CallSite.
+ */
+#ifdef SIMPLE_LOGGER_PROFILE_CALL_SITES
+#include "simple_logger_stats.h"
+#endif
@@ -0,0 +1,198 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2024 Marek Zelený
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "simple_logger_core.h"
+
+#include <coroutine>
+
+/**
+ * Logging from coroutines without blocking their threads (logAsync(), CO_LOG_* macros), kept out of
+ * simple_logger_core.h as it needs <coroutine>.
+ */
+
+namespace simple_logger {
+
+namespace detail {
+
+/**
+ * Hand a captured message over to the background thread, returns false if the thread's queue is full.
+ */
+SIMPLE_LOGGER_API bool tryPushRecord(std::span<const std::byte> record);
+
+/**
+ * Message of a coroutine suspended until the background thread writes it.
+ *
+ * Kept in the coroutine's awaitable (i.e. in its frame) like the message itself, so that waiting coroutines don't need
+ * any memory of the logger. Linked into the background thread's list of waiting messages while it waits.
+ */
+struct WaitingRecord {
+    std::span<const std::byte> record;
+    std::coroutine_handle<> coroutine;
+    // executor of the suspended thread (see setCoroutineExecutor()), taken when the message is handed over
+    void (*executor)(std::coroutine_handle<> coroutine, void *context){nullptr};
+    void *executorContext{nullptr};
+    WaitingRecord *next{nullptr};
+};
+
+/**
+ * Hand a captured message over to the background thread, which resumes the coroutine once it's written.
+ *
+ * Returns false if the message was written right away (the coroutine must not be suspended).
+ */
+SIMPLE_LOGGER_API bool pushRecordAndResume(WaitingRecord &waiting);
+
+} // detail
+
+/**
+ * Schedules a coroutine to be resumed on the thread it was suspended on, e.g. by posting it to the thread's event loop.
+ *
+ * Called by the background thread, so it must be thread-safe and shouldn't block.
+ */
+using CoroutineExecutor = void (*)(std::coroutine_handle<> coroutine, void *context);
+
+/**
+ * Set the executor of coroutines logging on the calling thread (see logAsync()), nullptr to resume them directly.
+ *
+ * Coroutines suspended because the thread's queue was full are then handed to `executor(coroutine, context)` once
+ * their message is written, instead of being resumed on the background thread. No effect in synchronous mode.
+ */
+SIMPLE_LOGGER_API void setCoroutineExecutor(CoroutineExecutor executor, void *context = nullptr);
+
+
+/**
+ * Log message for coroutines, which suspends the coroutine instead of blocking the thread if the message can't be
+ * handed over to the background thread right away (see logAsync()).
+ */
+template<LogLevel Level, typename Module = DefaultModule>
+class LogAwaitable {
+public:
+    static constexpr bool isActive{Level >= Module::logLevel};
+
+    template<typename... Args>
+    explicit LogAwaitable(const std::source_location &location, const Args &...args) {
+        if constexpr (isActive) {
+            if constexpr (Config::asynchronous) {
+                m_message.begin(Level, nullptr, location);
+                (m_message.capture(args), ...);
+            } else {
+                detail::beginRecord(m_message, Level, location);
+                (detail::print(m_message, args), ...);
+                m_message.append('\n');
+            }
+        }
+    }
+
+    bool await_ready() {
+        if constexpr (!isActive) {
+            return true;
+        } else if constexpr (Config::asynchronous) {
+            m_waiting.record = m_message.finish();
+            return detail::tryPushRecord(m_waiting.record);
+        } else {
+            detail::countMessage(Level, m_message.size());
+            detail::writeToSinks(Level, m_message.view());
+            return true;
+        }
+    }
+
+    bool await_suspend(std::coroutine_handle<> coroutine) {
+        if constexpr (isActive && Config::asynchronous) {
+            m_waiting.coroutine = coroutine;
+            return detail::pushRecordAndResume(m_waiting);
+        } else {
+            return false;
+        }
+    }
+
+    void await_resume() const noexcept {
+    }
+
+private:
+    struct Inactive {};
+    using Message = std::conditional_t<Config::asynchronous, detail::RecordCapture, RecordBuffer>;
+
+    [[no_unique_address]] std::conditional_t<isActive, Message, Inactive> m_message;
+    detail::WaitingRecord m_waiting;
+};
+
+/**
+ * Log a message from a coroutine without blocking its thread: `co_await logAsync<LogLevel::Info>(location, args...)`.
+ *
+ * The arguments are captured right away. If the thread's queue is full (in asynchronous mode), the coroutine is
+ * suspended (its message stays in its frame) until the background thread writes the message.
+ * Unless the thread has an executor (see setCoroutineExecutor()), the background thread then resumes the coroutine
+ * itself, so the coroutine continues on the background thread until its next suspension. Meanwhile, no other messages
+ * are written, and its own messages are written synchronously, so such coroutines should switch back to their thread
+ * right away.
+ * In synchronous mode, the message is written right away.
+ * The macros CO_LOG_INFO(...) etc. pass the location automatically.
+ */
+template<LogLevel Level, typename Module = DefaultModule, typename... Args>
+[[nodiscard]] LogAwaitable<Level, Module> logAsync(const std::source_location &location, const Args &...args) {
+    return LogAwaitable<Level, Module>(location, args...);
+}
+
+} // simple_logger
+
+#ifdef SIMPLE_LOGGER_ENABLE_MACROS
+
+/**
+ * Log a message on a given level from a coroutine, suspending it instead of blocking if the logger's queue is full.
+ */
+#define SIMPLE_LOGGER_CO_LOG(level, ...) \
+    if constexpr(simple_logger::LogAwaitable<simple_logger::LogLevel::level, SIMPLE_LOGGER_MODULE>::isActive) \
+        SIMPLE_LOGGER_STATEMENT(level, #__VA_ARGS__, (simple_logger::LogAwaitable<simple_logger::LogLevel::level, \
+                SIMPLE_LOGGER_MODULE>::isActive)) \
+        co_await simple_logger::logAsync<simple_logger::LogLevel::level, SIMPLE_LOGGER_MODULE>( \
+                std::source_location::current(), __VA_ARGS__)
+
+/**
+ * Log a trace message from a coroutine, e.g. `CO_LOG_TRACE("accepted connection ", fd);`.
+ */
+#define CO_LOG_TRACE(...) SIMPLE_LOGGER_CO_LOG(Trace, __VA_ARGS__)
+
+/**
+ * Log a debug message from a coroutine.
+ */
+#define CO_LOG_DEBUG(...) SIMPLE_LOGGER_CO_LOG(Debug, __VA_ARGS__)
+
+/**
+ * Log an info message from a coroutine.
+ */
+#define CO_LOG_INFO(...) SIMPLE_LOGGER_CO_LOG(Info, __VA_ARGS__)
+
+/**
+ * Log a warning message from a coroutine.
+ */
+#define CO_LOG_WARNING(...) SIMPLE_LOGGER_CO_LOG(Warning, __VA_ARGS__)
+
+/**
+ * Log an error message from a coroutine.
+ */
+#define CO_LOG_ERROR(...) SIMPLE_LOGGER_CO_LOG(Error, __VA_ARGS__)
+
+
+#endif // SIMPLE_LOGGER_ENABLE_MACROS
@@ -0,0 +1,423 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2024 Marek Zelený
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "simple_logger_core.h"
+
+#include <algorithm>
+#include <optional>
+#include <ostream>
+#include <ranges>
+#include <tuple>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/**
+ * Formatting helpers (fixed(), hex(), range(), ...) and printing of containers, tuples and optionals, kept out of
+ * simple_logger_core.h as they need heavy standard headers.
+ */
+
+namespace simple_logger {
+
+/**
+ * Floating point value with explicitly requested formatting, created by fixed() or scientific().
+ */
+template<std::floating_point T>
+struct FormattedFloat {
+    T value;
+    std::chars_format format;
+    int precision;
+};
+
+/**
+ * Print a floating point value with a given number of digits after the decimal point (e.g. fixed(x, 3) -> 12.345).
+ */
+template<typename T> requires std::is_arithmetic_v<T>
+constexpr auto fixed(T value, int precision) {
+    using Float = std::conditional_t<std::is_floating_point_v<T>, T, double>;
+    return FormattedFloat<Float>{static_cast<Float>(value), std::chars_format::fixed, precision};
+}
+
+/**
+ * Print a floating point value in scientific notation with a given number of digits after the decimal point.
+ */
+template<typename T> requires std::is_arithmetic_v<T>
+constexpr auto scientific(T value, int precision) {
+    using Float = std::conditional_t<std::is_floating_point_v<T>, T, double>;
+    return FormattedFloat<Float>{static_cast<Float>(value), std::chars_format::scientific, precision};
+}
+
+/**
+ * Binary data printed as hexadecimal digits, created by hex() or hexdump().
+ */
+struct HexBytes {
+    const std::byte *data;
+    std::size_t size;
+    /**
+     * If true, the data is printed on separate lines with offsets and ASCII column (like `hexdump -C`).
+     */
+    bool canonical;
+};
+
+/**
+ * Print binary data as a compact string of hexadecimal digits (e.g. hex(hash) -> 9f86d081884c7d65).
+ */
+inline HexBytes hex(const void *data, std::size_t size) {
+    return {static_cast<const std::byte *>(data), size, false};
+}
+
+template<std::ranges::contiguous_range R> requires std::is_trivially_copyable_v<std::ranges::range_value_t<R>>
+HexBytes hex(const R &range) {
+    return hex(std::ranges::data(range), std::ranges::size(range) * sizeof(std::ranges::range_value_t<R>));
+}
+
+/**
+ * Print binary data in the canonical hex+ASCII layout with offsets, 16 bytes per line, starting on a new line.
+ */
+inline HexBytes hexdump(const void *data, std::size_t size) {
+    return {static_cast<const std::byte *>(data), size, true};
+}
+
+template<std::ranges::contiguous_range R> requires std::is_trivially_copyable_v<std::ranges::range_value_t<R>>
+HexBytes hexdump(const R &range) {
+    return hexdump(std::ranges::data(range), std::ranges::size(range) * sizeof(std::ranges::range_value_t<R>));
+}
+
+/**
+ * Range printed with a custom element count limit, created by range().
+ */
+template<std::ranges::input_range R>
+struct LimitedRange {
+    const R &values;
+    std::size_t maxElements;
+};
+
+/**
+ * Print at most `maxElements` elements of a container or range (instead of the default Config::maxRangeElements).
+ */
+template<std::ranges::input_range R>
+LimitedRange<R> range(const R &values, std::size_t maxElements) {
+    return {values, maxElements};
+}
+
+namespace detail {
+
+inline constexpr char hexDigits[]{"0123456789abcdef"};
+
+/**
+ * Encode bytes as pairs of lowercase hexadecimal digits, writing exactly 2 * size characters.
+ *
+ * Translates 16 bytes at once with SSE2 (part of every x86-64 target): each nibble gets '0' added, and the distance
+ * between '9' + 1 and 'a' on top of that if it's greater than 9.
+ */
+inline void encodeHex(const std::byte *data, std::size_t size, char *out) {
+#ifdef __SSE2__
+    const __m128i lowNibble{_mm_set1_epi8(0x0f)};
+    const __m128i nine{_mm_set1_epi8(9)};
+    const __m128i zero{_mm_set1_epi8('0')};
+    const __m128i letterOffset{_mm_set1_epi8('a' - '9' - 1)};
+    auto toDigits = [&](__m128i nibbles) {
+        __m128i letters{_mm_and_si128(_mm_cmpgt_epi8(nibbles, nine), letterOffset)};
+        return _mm_add_epi8(_mm_add_epi8(nibbles, zero), letters);
+    };
+    for (; size >= 16; size -= 16, data += 16, out += 32) {
+        __m128i bytes{_mm_loadu_si128(reinterpret_cast<const __m128i *>(data))};
+        __m128i high{toDigits(_mm_and_si128(_mm_srli_epi16(bytes, 4), lowNibble))};
+        __m128i low{toDigits(_mm_and_si128(bytes, lowNibble))};
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out), _mm_unpacklo_epi8(high, low));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + 16), _mm_unpackhi_epi8(high, low));
+    }
+#endif
+    for (std::size_t i = 0; i < size; ++i) {
+        auto byte = std::to_integer<unsigned>(data[i]);
+        out[2 * i] = hexDigits[byte >> 4];
+        out[2 * i + 1] = hexDigits[byte & 0x0f];
+    }
+}
+
+inline constexpr std::size_t hexdumpBytesPerLine{16};
+inline constexpr std::size_t hexdumpOffsetDigits{8};
+
+/**
+ * Length of a full line of the canonical layout: newline, offset, separator, three columns per byte and one between
+ * the halves, "  |", the ASCII column and the closing '|'.
+ */
+inline constexpr std::size_t hexdumpLineLength{1 + hexdumpOffsetDigits + 1 + 3 * hexdumpBytesPerLine + 1 + 3
+        + hexdumpBytesPerLine + 1};
+
+/**
+ * Print one line of the canonical layout: "00000010  48 65 6c 6c 6f 2c 20 77  6f 72 6c 64 21 0a        |Hello, world!.|"
+ */
+inline char *encodeHexdumpLine(const std::byte *data, std::size_t size, std::size_t offset, char *out) {
+    constexpr std::size_t bytesPerLine{hexdumpBytesPerLine};
+    char digits[2 * bytesPerLine];
+    encodeHex(data, size, digits);
+
+    *out++ = '\n';
+    for (int shift = 4 * (hexdumpOffsetDigits - 1); shift >= 0; shift -= 4) {
+        *out++ = hexDigits[(offset >> shift) & 0x0f];
+    }
+    *out++ = ' ';
+    for (std::size_t i = 0; i < bytesPerLine; ++i) {
+        *out++ = ' ';
+        if (i == bytesPerLine / 2) {
+            *out++ = ' ';
+        }
+        *out++ = i < size ? digits[2 * i] : ' ';
+        *out++ = i < size ? digits[2 * i + 1] : ' ';
+    }
+    *out++ = ' ';
+    *out++ = ' ';
+    *out++ = '|';
+    for (std::size_t i = 0; i < size; ++i) {
+        auto byte = std::to_integer<unsigned char>(data[i]);
+        *out++ = byte >= 0x20 && byte < 0x7f ? static_cast<char>(byte) : '.';
+    }
+    *out++ = '|';
+    return out;
+}
+
+inline void printHex(RecordBuffer &buffer, const HexBytes &token) {
+    if (!token.canonical) {
+        encodeHex(token.data, token.size, buffer.reserve(2 * token.size));
+        buffer.commit(2 * token.size);
+        return;
+    }
+    std::size_t lines{(token.size + hexdumpBytesPerLine - 1) / hexdumpBytesPerLine};
+    char *start{buffer.reserve(lines * hexdumpLineLength)};
+    char *out{start};
+    for (std::size_t offset = 0; offset < token.size; offset += hexdumpBytesPerLine) {
+        out = encodeHexdumpLine(token.data + offset, std::min(hexdumpBytesPerLine, token.size - offset), offset, out);
+    }
+    buffer.commit(out - start);
+}
+
+template<typename T>
+concept TupleLike = requires {
+    std::tuple_size<T>::value;
+};
+
+template<typename T>
+inline constexpr bool isOptional{false};
+
+template<typename T>
+inline constexpr bool isOptional<std::optional<T>>{true};
+
+template<typename R>
+concept MapLike = std::ranges::input_range<const R> && requires {
+    typename R::key_type;
+    typename R::mapped_type;
+};
+
+template<typename R>
+concept IntegerRange = std::ranges::sized_range<const R> && std::integral<std::ranges::range_value_t<const R>>
+        && !isCharacter<std::ranges::range_value_t<const R>> && !std::is_same_v<std::ranges::range_value_t<const R>, bool>;
+
+/**
+ * Batched fast path for ranges of integers: space for all printed elements is reserved at once.
+ */
+template<IntegerRange R>
+void printIntegers(RecordBuffer &buffer, const R &range, std::size_t count) {
+    constexpr std::size_t maxLength{std::numeric_limits<std::ranges::range_value_t<const R>>::digits10 + 2};
+    constexpr std::size_t separatorLength{2};
+    char *start{buffer.reserve(count * (maxLength + separatorLength))};
+    char *out{start};
+    auto it = std::ranges::begin(range);
+    for (std::size_t i = 0; i < count; ++i, ++it) {
+        if (i > 0) {
+            *out++ = ',';
+            *out++ = ' ';
+        }
+        out = std::to_chars(out, out + maxLength, *it).ptr;
+    }
+    buffer.commit(out - start);
+}
+
+/**
+ * Print elements of a range separated by commas, e.g. [1, 2, 3] or {key: value, ...} for maps.
+ *
+ * Elements over the limit are replaced by a truncation marker, e.g. [1, 2, 3, ...(97 more)].
+ */
+template<std::ranges::input_range R>
+void printRange(RecordBuffer &buffer, const R &range, std::size_t maxElements) {
+    buffer.append(MapLike<R> ? '{' : '[');
+    std::size_t printed{0};
+    if constexpr (IntegerRange<R>) {
+        if (buffer.hasDefaultFormat(FormatKind::Integer)) {
+            printed = std::min<std::size_t>(maxElements, std::ranges::size(range));
+            printIntegers(buffer, range, printed);
+        }
+    }
+    auto it = std::ranges::begin(range);
+    std::ranges::advance(it, static_cast<std::ranges::range_difference_t<const R>>(printed));
+    for (; it != std::ranges::end(range) && printed < maxElements; ++it, ++printed) {
+        if (printed > 0) {
+            buffer.append(", ");
+        }
+        if constexpr (MapLike<R>) {
+            print(buffer, (*it).first);
+            buffer.append(": ");
+            print(buffer, (*it).second);
+        } else {
+            print(buffer, *it);
+        }
+    }
+    if (it != std::ranges::end(range)) {
+        buffer.append(printed > 0 ? ", ..." : "...");
+        if constexpr (std::ranges::sized_range<const R>) {
+            buffer.append('(');
+            printInteger(buffer, std::ranges::size(range) - printed);
+            buffer.append(" more)");
+        }
+    }
+    buffer.append(MapLike<R> ? '}' : ']');
+}
+
+/**
+ * Print elements of a tuple-like type (std::pair, std::tuple) in parentheses, e.g. (1, text).
+ */
+template<TupleLike T>
+void printTuple(RecordBuffer &buffer, const T &tuple) {
+    buffer.append('(');
+    std::apply([&buffer](const auto &...elements) {
+        std::size_t index{0};
+        ((buffer.append(index++ > 0 ? ", " : ""), print(buffer, elements)), ...);
+    }, tuple);
+    buffer.append(')');
+}
+
+
+/**
+ * Print a container or range, a tuple-like type or an optional element by element (see print()).
+ */
+template<typename T>
+struct CompositePrinter {
+    static void print(RecordBuffer &buffer, const T &token)
+            requires std::ranges::input_range<const T> || isOptional<T> || TupleLike<T> {
+        if constexpr (std::ranges::input_range<const T>) {
+            printRange(buffer, token, Config::maxRangeElements);
+        } else if constexpr (isOptional<T>) {
+            if (token.has_value()) {
+                detail::print(buffer, *token);
+            } else {
+                buffer.append("none");
+            }
+        } else {
+            printTuple(buffer, token);
+        }
+    }
+};
+
+/**
+ * Stream buffer of RecordBuffer::stream(), writing into the record buffer.
+ */
+class RecordStreamBuffer : public std::streambuf {
+public:
+    explicit RecordStreamBuffer(RecordBuffer &buffer) : m_buffer(buffer) {
+    }
+
+    RecordBuffer &buffer() const {
+        return m_buffer;
+    }
+
+protected:
+    int_type overflow(int_type character) override {
+        if (!traits_type::eq_int_type(character, traits_type::eof())) {
+            m_buffer.append(traits_type::to_char_type(character));
+        }
+        return traits_type::not_eof(character);
+    }
+
+    std::streamsize xsputn(const char *text, std::streamsize count) override {
+        m_buffer.append(std::string_view(text, count));
+        return count;
+    }
+
+private:
+    RecordBuffer &m_buffer;
+};
+
+/**
+ * Print a token supported by the record buffer into an arbitrary stream (e.g. one obtained by Log::getStream()).
+ */
+template<typename T>
+std::ostream &printToStream(std::ostream &stream, const T &token) {
+    if (auto *recordStream = dynamic_cast<RecordStreamBuffer *>(stream.rdbuf())) {
+        print(recordStream->buffer(), token);
+    } else {
+        RecordBuffer buffer;
+        print(buffer, token);
+        stream.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    }
+    return stream;
+}
+
+template<bool Canonical>
+void printCapturedBytes(const std::byte *data, std::size_t size, RecordBuffer &buffer) {
+    printHex(buffer, HexBytes{data, size, Canonical});
+}
+
+} // detail
+
+template<std::floating_point T>
+struct Formatter<FormattedFloat<T>> {
+    static constexpr bool deferred{true};
+
+    static void format(const FormattedFloat<T> &token, RecordBuffer &buffer) {
+        detail::printFloat(buffer, token.value, token.format, token.precision);
+    }
+};
+
+template<>
+struct Formatter<HexBytes> {
+    static void format(const HexBytes &token, RecordBuffer &buffer) {
+        detail::printHex(buffer, token);
+    }
+
+    static detail::CapturedBytes capture(const HexBytes &token) {
+        return {token.canonical ? &detail::printCapturedBytes<true> : &detail::printCapturedBytes<false>, token.data,
+                token.size};
+    }
+};
+
+template<std::ranges::input_range R>
+struct Formatter<LimitedRange<R>> {
+    static void format(const LimitedRange<R> &token, RecordBuffer &buffer) {
+        detail::printRange(buffer, token.values, token.maxElements);
+    }
+};
+
+/**
+ * Allows printing the logger's helper types (e.g. hex(), fixed()) to any stream.
+ */
+template<HasFormatter T>
+std::ostream &operator<<(std::ostream &stream, const T &token) {
+    return detail::printToStream(stream, token);
+}
+
+
+} // simple_logger
@@ -0,0 +1,254 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2024 Marek Zelený
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "simple_logger_core.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <vector>
+
+/**
+ * The logger's own statistics, latency histograms, call site profiling and the statement catalog, kept out of
+ * simple_logger_core.h as they need heavy standard headers (included by it only for SIMPLE_LOGGER_PROFILE_CALL_SITES).
+ */
+
+namespace simple_logger {
+
+namespace detail {
+
+/**
+ * Buckets of a log-linear histogram: each power of 2 is split into 8 linear buckets (i.e. precision of ~12%).
+ */
+struct LogLinearBuckets {
+    static constexpr unsigned subBucketBits{3};
+    static constexpr std::size_t subBucketCount{std::size_t{1} << subBucketBits};
+    // values below this limit have their own bucket
+    static constexpr std::uint64_t linearLimit{2 * subBucketCount};
+    static constexpr std::size_t count{linearLimit + (64 - std::bit_width(linearLimit - 1)) * subBucketCount};
+
+    static constexpr std::size_t index(std::uint64_t value) {
+        if (value < linearLimit) {
+            return static_cast<std::size_t>(value);
+        }
+        unsigned exponent{static_cast<unsigned>(std::bit_width(value)) - 1};
+        std::size_t subBucket{static_cast<std::size_t>(value >> (exponent - subBucketBits)) & (subBucketCount - 1)};
+        return linearLimit + (exponent - subBucketBits - 1) * subBucketCount + subBucket;
+    }
+
+    /**
+     * Largest value falling into a bucket.
+     */
+    static constexpr std::uint64_t upperBound(std::size_t index) {
+        if (index < linearLimit) {
+            return index;
+        }
+        unsigned exponent{static_cast<unsigned>((index - linearLimit) / subBucketCount) + subBucketBits + 1};
+        std::uint64_t subBucket{(index - linearLimit) % subBucketCount};
+        std::uint64_t lowerBound{(subBucketCount + subBucket) << (exponent - subBucketBits)};
+        return lowerBound + (std::uint64_t{1} << (exponent - subBucketBits)) - 1;
+    }
+};
+
+} // detail
+
+/**
+ * Snapshot of a histogram of durations, e.g. of log messages (see logLatency()).
+ */
+class Histogram {
+public:
+    /**
+     * @param nanosecondsPerTick Duration of a unit of recorded values
+     */
+    explicit Histogram(double nanosecondsPerTick = 1.0) : m_nanosecondsPerTick(nanosecondsPerTick) {
+    }
+
+    std::uint64_t count() const {
+        return m_count;
+    }
+
+    /**
+     * Duration which given fraction of the recorded durations doesn't exceed (e.g. 0.99), with precision of ~12%.
+     */
+    std::chrono::nanoseconds percentile(double fraction) const {
+        if (m_count == 0) {
+            return std::chrono::nanoseconds{0};
+        }
+        auto rank = static_cast<std::uint64_t>(std::clamp(fraction, 0.0, 1.0) * static_cast<double>(m_count - 1));
+        std::uint64_t seen{0};
+        for (std::size_t i = 0; i < m_buckets.size(); ++i) {
+            seen += m_buckets[i];
+            if (seen > rank) {
+                return std::chrono::nanoseconds{static_cast<std::int64_t>(
+                        static_cast<double>(detail::LogLinearBuckets::upperBound(i)) * m_nanosecondsPerTick)};
+            }
+        }
+        return std::chrono::nanoseconds{0};
+    }
+
+    /**
+     * Add a value (in units of the histogram, see the constructor).
+     */
+    void add(std::uint64_t value, std::uint64_t count = 1) {
+        m_buckets[detail::LogLinearBuckets::index(value)] += count;
+        m_count += count;
+    }
+
+    /**
+     * Add counts of a bucket (used when merging histograms).
+     */
+    void addToBucket(std::size_t index, std::uint64_t count) {
+        m_buckets[index] += count;
+        m_count += count;
+    }
+
+private:
+    std::array<std::uint64_t, detail::LogLinearBuckets::count> m_buckets{};
+    std::uint64_t m_count{0};
+    double m_nanosecondsPerTick;
+};
+
+/**
+ * Histogram of durations of log messages of a level since the start of the program (see Config::measureLatency).
+ *
+ * For example `logLatency(LogLevel::Info).percentile(0.999)` shows whether logging contributes to tail latency.
+ */
+SIMPLE_LOGGER_API Histogram logLatency(LogLevel level);
+
+/**
+ * The logger's own metrics since the start of the program (see stats() and Config::collectStats).
+ */
+struct Stats {
+    // number of log messages of each level
+    std::array<std::uint64_t, logLevelCount> messages{};
+    // total size of the written messages of each level (including prefixes and newlines)
+    std::array<std::uint64_t, logLevelCount> bytes{};
+    // writes of messages which failed (e.g. because the log file couldn't be opened), counted for each stream
+    std::uint64_t dropped{0};
+    // how many times a logging thread had to wait because its queue was full (asynchronous mode)
+    std::uint64_t queueFullWaits{0};
+    // largest number of bytes seen waiting in a thread's queue (asynchronous mode)
+    std::size_t queueHighWatermark{0};
+    // durations of flushes of streams and sinks (its count() is the number of flushes)
+    Histogram flushDurations{};
+    // time the background thread spent writing messages, including flushes (asynchronous mode)
+    std::chrono::nanoseconds writerBusyTime{0};
+};
+
+/**
+ * Snapshot of the logger's own metrics (counters of all threads merged), e.g. for exporting them to monitoring.
+ *
+ * All values are zero if Config::collectStats is false.
+ */
+SIMPLE_LOGGER_API Stats stats();
+
+/**
+ * Log the logger's statistics (see stats()) as an Info message.
+ */
+SIMPLE_LOGGER_API void logStats();
+
+namespace detail {
+
+/**
+ * Counters of a line logging messages, created as a static variable by the convenience macros.
+ *
+ * Call sites are never destroyed (so that they can be used by static destructors), they form a list for
+ * noisiestCallSites().
+ */
+class CallSite {
+public:
+    explicit CallSite(LogLevel level, const std::source_location location = std::source_location::current()) :
+            m_location(location), m_level(level), m_next(s_head.load(std::memory_order_relaxed)) {
+        while (!s_head.compare_exchange_weak(m_next, this, std::memory_order_release, std::memory_order_relaxed)) {
+        }
+    }
+
+    CallSite(const CallSite &) = delete;
+    CallSite &operator=(const CallSite &) = delete;
+
+    void add(std::size_t bytes) {
+        m_messages.fetch_add(1, std::memory_order_relaxed);
+        m_bytes.fetch_add(bytes, std::memory_order_relaxed);
+    }
+
+    template<typename F>
+    static void forEach(F &&function) {
+        for (const CallSite *site = s_head.load(std::memory_order_acquire); site != nullptr; site = site->m_next) {
+            function(site->m_location, site->m_level, site->m_messages.load(std::memory_order_relaxed),
+                    site->m_bytes.load(std::memory_order_relaxed));
+        }
+    }
+
+private:
+    static inline std::atomic<CallSite *> s_head{nullptr};
+
+    const std::source_location m_location;
+    const LogLevel m_level;
+    CallSite *m_next;
+    std::atomic<std::uint64_t> m_messages{0};
+    std::atomic<std::uint64_t> m_bytes{0};
+};
+
+} // detail
+
+/**
+ * Messages written by a line since the start of the program (see noisiestCallSites()).
+ */
+struct CallSiteStats {
+    const char *file;
+    std::uint_least32_t line;
+    LogLevel level;
+    std::uint64_t messages;
+    // total size of the written messages (including prefixes and newlines)
+    std::uint64_t bytes;
+};
+
+/**
+ * Call sites of the convenience macros which wrote the most bytes, in descending order (see Config::profileCallSites).
+ *
+ * Useful for finding the few chatty lines that fill most of the log files.
+ */
+SIMPLE_LOGGER_API std::vector<CallSiteStats> noisiestCallSites(std::size_t count = 10);
+
+/**
+ * All active log statements of the executable, without any registration at startup (see Config::statementCatalog).
+ *
+ * The catalog is a section of the executable, so tools can read it without running the program, and a statement's
+ * index is a compact id of it (stable for a given build).
+ * The order follows the linker's input, templates and inline functions are listed once (for each instantiation).
+ */
+inline std::span<const LogStatement *const> logStatements() {
+#ifdef SIMPLE_LOGGER_STATEMENT_CATALOG
+    if (detail::__start_simple_logger_statements != nullptr) {
+        return {detail::__start_simple_logger_statements, detail::__stop_simple_logger_statements};
+    }
+#endif
+    return {};
+}
+
+} // simple_logger
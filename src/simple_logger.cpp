@@ -0,0 +1,7 @@
+/**
+ * Backend of the logger compiled once (see SIMPLE_LOGGER_COMPILED), so that translation units which log only need
+ * simple_logger_core.h.
+ */
+
+#define SIMPLE_LOGGER_IMPLEMENTATION
+#include <simple_logger.h>
@@ -0,0 +1,188 @@
+/**
+ * Checks that logging a typical message performs no heap allocations once the logger is warmed up (lazily created
+ * queues, thread-local counters etc. are allocated by the first messages).
+ *
+ * Global operator new and (with glibc) malloc are replaced by counting versions, allocations of all threads are
+ * counted, including the background thread in asynchronous mode.
+ * Built once per logging mode (see tests/CMakeLists.txt): synchronous, asynchronous, linked with the compiled library,
+ * with formatter threads, and measuring latency or profiling call sites (both synchronous and asynchronous).
+ */
+
+#include <simple_logger.h>
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <new>
+#include <string_view>
+
+#ifdef __GLIBC__
+extern "C" {
+void *__libc_malloc(std::size_t size);
+void *__libc_calloc(std::size_t count, std::size_t size);
+void *__libc_realloc(void *pointer, std::size_t size);
+}
+#endif
+
+namespace {
+
+std::atomic<std::size_t> allocations{0};
+std::atomic<bool> counting{false};
+
+void countAllocation() {
+    if (counting.load(std::memory_order_relaxed)) {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void *allocate(std::size_t size) {
+    countAllocation();
+    // not through the counting malloc(), so that each allocation is counted once
+#ifdef __GLIBC__
+    void *pointer{__libc_malloc(size == 0 ? 1 : size)};
+#else
+    void *pointer{std::malloc(size == 0 ? 1 : size)};
+#endif
+    if (pointer != nullptr) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void *allocateAligned(std::size_t size, std::align_val_t alignment) {
+    countAllocation();
+    auto align = static_cast<std::size_t>(alignment);
+    if (void *pointer = std::aligned_alloc(align, (size + align - 1) / align * align)) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+} // namespace
+
+void *operator new(std::size_t size) {
+    return allocate(size);
+}
+
+void *operator new[](std::size_t size) {
+    return allocate(size);
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment) {
+    return allocateAligned(size, alignment);
+}
+
+void *operator new[](std::size_t size, std::align_val_t alignment) {
+    return allocateAligned(size, alignment);
+}
+
+void operator delete(void *pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void *pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void *pointer, std::size_t) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void *pointer, std::size_t) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void *pointer, std::align_val_t) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void *pointer, std::align_val_t) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void *pointer, std::size_t, std::align_val_t) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void *pointer, std::size_t, std::align_val_t) noexcept {
+    std::free(pointer);
+}
+
+#ifdef __GLIBC__
+// also catch allocations bypassing operator new (e.g. inside the C library)
+extern "C" {
+
+void *malloc(std::size_t size) {
+    countAllocation();
+    return __libc_malloc(size);
+}
+
+void *calloc(std::size_t count, std::size_t size) {
+    countAllocation();
+    return __libc_calloc(count, size);
+}
+
+void *realloc(void *pointer, std::size_t size) {
+    countAllocation();
+    return __libc_realloc(pointer, size);
+}
+
+}
+#endif
+
+using namespace simple_logger;
+
+namespace {
+
+// enough to fill every batch of the formatter threads (see Config::asyncFormatterThreads) at least once
+constexpr int warmupMessages{10000};
+constexpr int measuredMessages{100000};
+
+template<typename F>
+bool expectNoAllocations(const char *name, F &&logMessage) {
+    // the longest messages (numbered like the last measured ones), so that buffers don't need to grow later
+    for (int i = measuredMessages - warmupMessages; i < measuredMessages; ++i) {
+        logMessage(i);
+    }
+    flush();
+    allocations.store(0);
+    counting.store(true);
+    for (int i = 0; i < measuredMessages; ++i) {
+        logMessage(i);
+    }
+    flush();
+    counting.store(false);
+    std::size_t count{allocations.load()};
+    std::printf("%-20s %zu allocations in %d messages\n", name, count, measuredMessages);
+    return count == 0;
+}
+
+} // namespace
+
+int main() {
+    const char *logFile{"simple_logger_allocation_test.log"};
+    const char *streamFile{"simple_logger_allocation_test_stream.log"};
+    Config::logFileName = logFile;
+    constexpr std::string_view name{"allocation"};
+    bool passed{true};
+
+    passed &= expectNoAllocations("log file", [name](int i) {
+        LOG_INFO << i << " messages of the " << name << " test";
+    });
+    {
+        std::ofstream stream{streamFile};
+        passed &= expectNoAllocations("custom ofstream", [&stream, name](int i) {
+            Log<LogLevel::Info>(stream) << i << " messages of the " << name << " test";
+        });
+        shutdown();
+    }
+
+    std::remove(logFile);
+    std::remove(streamFile);
+    if (!passed) {
+        std::puts("FAILED: logging allocated memory in steady state");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
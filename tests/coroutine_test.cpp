@@ -0,0 +1,133 @@
+/**
+ * Checks logging from a coroutine whose thread's queue fills up in asynchronous mode (built with
+ * SIMPLE_LOGGER_ASYNCHRONOUS).
+ *
+ * The coroutine logs much more than fits into the queue, so it's suspended repeatedly. Its thread's executor must get
+ * it back every time (it never runs on the background thread), and all messages must be written in order.
+ */
+
+#include <simple_logger.h>
+
+#include <coroutine>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+
+using namespace simple_logger;
+
+namespace {
+
+constexpr int messageCount{100'000};
+
+/**
+ * Coroutine started right away and destroyed when it finishes.
+ */
+struct Task {
+    struct promise_type {
+        Task get_return_object() {
+            return {};
+        }
+
+        std::suspend_never initial_suspend() {
+            return {};
+        }
+
+        std::suspend_never final_suspend() noexcept {
+            return {};
+        }
+
+        void return_void() {
+        }
+
+        void unhandled_exception() {
+            std::terminate();
+        }
+    };
+};
+
+/**
+ * Event loop of the main thread, coroutines are posted to it by the background thread.
+ */
+struct EventLoop {
+    std::mutex mutex;
+    std::deque<std::coroutine_handle<>> ready;
+    int posted{0};
+
+    static void post(std::coroutine_handle<> coroutine, void *context) {
+        auto &loop = *static_cast<EventLoop *>(context);
+        std::lock_guard lock{loop.mutex};
+        loop.ready.push_back(coroutine);
+        ++loop.posted;
+    }
+
+    bool runOne() {
+        std::coroutine_handle<> coroutine;
+        {
+            std::lock_guard lock{mutex};
+            if (ready.empty()) {
+                return false;
+            }
+            coroutine = ready.front();
+            ready.pop_front();
+        }
+        coroutine.resume();
+        return true;
+    }
+};
+
+bool finished{false};
+int foreignResumes{0};
+
+Task logMessages(std::thread::id loopThread) {
+    std::string padding(100, '.');
+    for (int i = 0; i < messageCount; ++i) {
+        CO_LOG_INFO("message ", i, ' ', padding);
+        foreignResumes += std::this_thread::get_id() != loopThread;
+    }
+    finished = true;
+}
+
+bool report(const char *name, bool passed) {
+    std::printf("%-20s %s\n", name, passed ? "ok" : "FAILED");
+    return passed;
+}
+
+} // namespace
+
+int main() {
+    const char *logFile{"simple_logger_coroutine_test.log"};
+    Config::logFileName = logFile;
+
+    EventLoop loop;
+    setCoroutineExecutor(&EventLoop::post, &loop);
+    logMessages(std::this_thread::get_id());
+    while (!finished) {
+        if (!loop.runOne()) {
+            std::this_thread::yield();
+        }
+    }
+    flush();
+
+    int expected{0};
+    bool ordered{true};
+    {
+        std::ifstream file{logFile};
+        for (std::string line; std::getline(file, line); ++expected) {
+            std::size_t start{line.find("message ")};
+            ordered = ordered && start != std::string::npos && std::stoi(line.substr(start + 8)) == expected;
+        }
+    }
+
+    bool passed{true};
+    passed &= report("suspended", loop.posted > 0);
+    passed &= report("resumed by executor", foreignResumes == 0);
+    passed &= report("written in order", ordered && expected == messageCount);
+    shutdown();
+    std::remove(logFile);
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,92 @@
+/**
+ * Checks which values are formatted by the background thread in asynchronous mode (built with
+ * SIMPLE_LOGGER_ASYNCHRONOUS).
+ *
+ * A type referring to other memory must be formatted by the logging thread (its Formatter doesn't opt in to deferred
+ * formatting), so that it prints what it referred to when it was logged. A Formatter opting in is run by the
+ * background thread.
+ */
+
+#include <simple_logger.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <thread>
+
+using namespace simple_logger;
+
+namespace {
+
+std::thread::id labelThread;
+std::thread::id pointThread;
+
+/**
+ * Trivially copyable type referring to other memory, its formatter doesn't opt in to deferred formatting.
+ */
+struct Label {
+    std::string_view text;
+};
+
+/**
+ * Trivially copyable value type, its formatter opts in.
+ */
+struct Point {
+    int x;
+    int y;
+};
+
+} // namespace
+
+template<>
+struct simple_logger::Formatter<Label> {
+    static void format(const Label &label, RecordBuffer &buffer) {
+        labelThread = std::this_thread::get_id();
+        buffer << label.text;
+    }
+};
+
+template<>
+struct simple_logger::Formatter<Point> {
+    static constexpr bool deferred{true};
+
+    static void format(const Point &point, RecordBuffer &buffer) {
+        pointThread = std::this_thread::get_id();
+        buffer << '(' << point.x << ", " << point.y << ')';
+    }
+};
+
+namespace {
+
+bool report(const char *name, bool passed) {
+    std::printf("%-20s %s\n", name, passed ? "ok" : "FAILED");
+    return passed;
+}
+
+} // namespace
+
+int main() {
+    const char *logFile{"simple_logger_deferral_test.log"};
+    Config::logFileName = logFile;
+
+    std::string text{"original label"};
+    LOG_INFO << "label " << Label{text} << " at " << Point{1, 2};
+    text.replace(0, 8, "modified");
+    flush();
+    std::string contents;
+    {
+        std::ifstream file{logFile};
+        contents.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+
+    bool passed{true};
+    passed &= report("string_view label", contents.find("label original label at (1, 2)\n") != std::string::npos);
+    passed &= report("label thread", labelThread == std::this_thread::get_id());
+    passed &= report("deferred thread", pointThread != std::thread::id{} && pointThread != std::this_thread::get_id());
+    shutdown();
+    std::remove(logFile);
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
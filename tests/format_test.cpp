@@ -0,0 +1,103 @@
+/**
+ * Checks the output of the formatting helpers against references computed independently of the logger.
+ *
+ * Messages are logged into a string stream (i.e. formatted right away in asynchronous mode as well) and compared after
+ * their prefix.
+ */
+
+#include <simple_logger.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+
+using namespace simple_logger;
+
+namespace {
+
+/**
+ * Text of a message logged into a string stream, after the "text" marker logged first.
+ */
+template<typename T>
+std::string logged(const T &value) {
+    std::ostringstream stream;
+    Log<LogLevel::Info>(stream) << "text" << value;
+    std::string output{stream.str()};
+    std::size_t start{output.find("text")};
+    return start != std::string::npos ? output.substr(start + 4) : output;
+}
+
+bool report(const char *name, std::size_t size, bool matches) {
+    std::printf("%-20s %4zu bytes %s\n", name, size, matches ? "match" : "DIFFER");
+    return matches;
+}
+
+std::string testData(std::size_t size) {
+    std::string data(size, '\0');
+    for (std::size_t i = 0; i < size; ++i) {
+        data[i] = static_cast<char>(i * 7);
+    }
+    return data;
+}
+
+/**
+ * Check hex() of the given size (vectorized for each 16 bytes, the rest one by one) against printf.
+ */
+bool checkHex(std::size_t size) {
+    std::string data{testData(size)};
+    std::string expected;
+    for (char byte : data) {
+        char digits[3];
+        std::snprintf(digits, sizeof(digits), "%02x", static_cast<unsigned char>(byte));
+        expected += digits;
+    }
+    return report("hex", size, logged(hex(data.data(), size)) == expected + '\n');
+}
+
+/**
+ * Check a hexdump of the given size against the layout of `hexdump -C` (without the final offset line).
+ */
+bool checkHexdump(std::size_t size) {
+    std::string data{testData(size)};
+    std::string expected;
+    for (std::size_t offset = 0; offset < size; offset += 16) {
+        char line[80];
+        int length{std::snprintf(line, sizeof(line), "\n%08zx ", offset)};
+        expected.append(line, static_cast<std::size_t>(length));
+        for (std::size_t i = 0; i < 16; ++i) {
+            expected += i == 8 ? "  " : " ";
+            if (offset + i < size) {
+                std::snprintf(line, sizeof(line), "%02x", static_cast<unsigned char>(data[offset + i]));
+                expected += line;
+            } else {
+                expected += "  ";
+            }
+        }
+        expected += "  |";
+        for (std::size_t i = offset; i < std::min(size, offset + 16); ++i) {
+            auto character = static_cast<unsigned char>(data[i]);
+            expected += character >= 0x20 && character < 0x7f ? static_cast<char>(character) : '.';
+        }
+        expected += '|';
+    }
+    return report("hexdump", size, logged(hexdump(data.data(), size)) == expected + '\n');
+}
+
+} // namespace
+
+int main() {
+    bool passed{true};
+    for (std::size_t size : {0, 1, 15, 16, 17, 40, 256}) {
+        passed &= checkHex(size);
+    }
+    // multi-line hexdumps don't fit into the record's inline buffer
+    passed &= checkHexdump(1024);
+    passed &= checkHexdump(200);
+    if (!passed) {
+        std::puts("FAILED: formatted output differs from the reference");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,309 @@
+/**
+ * Reading log files written by the logger, shared by the command line tools in this directory.
+ *
+ * Each record starts at the beginning of a line with the prefix `[HH:MM:SS.mmm][Level][file:line]` (see
+ * printPrefix()), lines not starting with it continue the previous record (e.g. hexdumps or multi-line strings).
+ * The prefix has no date, so times are counted from midnight of a file's first record (see Timeline).
+ */
+
+#pragma once
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+namespace simple_logger::tools {
+
+inline constexpr std::int64_t millisecondsPerDay{24 * 60 * 60 * 1000};
+
+/**
+ * Names of the levels as printed in the prefix, from the lowest one (as logLevelToString(), without depending on the
+ * logger itself).
+ */
+inline constexpr std::array<std::string_view, 5> levelNames{"Trace", "Debug", "Info", "Warning", "Error"};
+
+/**
+ * Read-only memory mapping of a whole file, throws std::system_error if the file can't be mapped.
+ */
+class MappedFile {
+public:
+    explicit MappedFile(const std::string &path) {
+        int descriptor{::open(path.c_str(), O_RDONLY | O_CLOEXEC)};
+        if (descriptor < 0) {
+            throw std::system_error(errno, std::generic_category(), path);
+        }
+        struct stat status{};
+        if (::fstat(descriptor, &status) != 0) {
+            int error{errno};
+            ::close(descriptor);
+            throw std::system_error(error, std::generic_category(), path);
+        }
+        m_size = static_cast<std::size_t>(status.st_size);
+        m_modificationTime = static_cast<std::int64_t>(status.st_mtim.tv_sec) * 1'000'000'000
+                + status.st_mtim.tv_nsec;
+        if (m_size > 0) {
+            void *data{::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, descriptor, 0)};
+            if (data == MAP_FAILED) {
+                int error{errno};
+                ::close(descriptor);
+                throw std::system_error(error, std::generic_category(), path);
+            }
+            m_data = static_cast<const char *>(data);
+            ::madvise(data, m_size, MADV_SEQUENTIAL);
+        }
+        ::close(descriptor);
+    }
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    ~MappedFile() {
+        if (m_data != nullptr) {
+            ::munmap(const_cast<char *>(m_data), m_size);
+        }
+    }
+
+    std::string_view view() const {
+        return {m_data, m_size};
+    }
+
+    /**
+     * Time of the file's last modification in nanoseconds since the epoch (to detect outdated index files).
+     */
+    std::int64_t modificationTime() const {
+        return m_modificationTime;
+    }
+
+private:
+    const char *m_data{nullptr};
+    std::size_t m_size{0};
+    std::int64_t m_modificationTime{0};
+};
+
+namespace detail {
+inline bool isDigit(char character) {
+    return character >= '0' && character <= '9';
+}
+
+inline int twoDigits(const char *text) {
+    return (text[0] - '0') * 10 + (text[1] - '0');
+}
+} // detail
+
+/**
+ * Time of day (in milliseconds) of a line starting with a record's prefix, nullopt for other lines.
+ */
+inline std::optional<std::int64_t> parsePrefixTime(std::string_view line) {
+    using detail::isDigit;
+    if (line.size() < 14 || line[0] != '[' || line[3] != ':' || line[6] != ':' || line[9] != '.' || line[13] != ']'
+            || !isDigit(line[1]) || !isDigit(line[2]) || !isDigit(line[4]) || !isDigit(line[5])
+            || !isDigit(line[7]) || !isDigit(line[8]) || !isDigit(line[10]) || !isDigit(line[11])
+            || !isDigit(line[12])) {
+        return std::nullopt;
+    }
+    std::int64_t hours{detail::twoDigits(&line[1])};
+    std::int64_t minutes{detail::twoDigits(&line[4])};
+    std::int64_t seconds{detail::twoDigits(&line[7])};
+    std::int64_t milliseconds{(line[10] - '0') * 100 + detail::twoDigits(&line[11])};
+    return ((hours * 60 + minutes) * 60 + seconds) * 1000 + milliseconds;
+}
+
+/**
+ * Time of day given on a command line (`HH:MM`, `HH:MM:SS` or `HH:MM:SS.mmm`) in milliseconds.
+ */
+inline std::optional<std::int64_t> parseTimeOfDay(std::string_view text) {
+    using detail::isDigit;
+    if ((text.size() != 5 && text.size() != 8 && text.size() != 12) || !isDigit(text[0]) || !isDigit(text[1])
+            || text[2] != ':' || !isDigit(text[3]) || !isDigit(text[4])) {
+        return std::nullopt;
+    }
+    std::int64_t time{(detail::twoDigits(&text[0]) * 60 + detail::twoDigits(&text[3])) * 60 * 1000};
+    if (text.size() >= 8) {
+        if (text[5] != ':' || !isDigit(text[6]) || !isDigit(text[7])) {
+            return std::nullopt;
+        }
+        time += detail::twoDigits(&text[6]) * 1000;
+    }
+    if (text.size() == 12) {
+        if (text[8] != '.' || !isDigit(text[9]) || !isDigit(text[10]) || !isDigit(text[11])) {
+            return std::nullopt;
+        }
+        time += (text[9] - '0') * 100 + detail::twoDigits(&text[10]);
+    }
+    return time < millisecondsPerDay ? std::optional(time) : std::nullopt;
+}
+
+/**
+ * Offset of the first record starting at or after the given offset (the data's size if there's none).
+ */
+inline std::size_t findRecord(std::string_view data, std::size_t offset) {
+    while (offset < data.size()) {
+        if (offset == 0 || data[offset - 1] == '\n') {
+            if (parsePrefixTime(data.substr(offset, 14))) {
+                return offset;
+            }
+        }
+        const void *newline{std::memchr(data.data() + offset, '\n', data.size() - offset)};
+        if (newline == nullptr) {
+            return data.size();
+        }
+        offset = static_cast<std::size_t>(static_cast<const char *>(newline) - data.data()) + 1;
+    }
+    return data.size();
+}
+
+/**
+ * Offset just after the record starting at the given offset (i.e. of the next record or the data's end).
+ */
+inline std::size_t recordEnd(std::string_view data, std::size_t offset) {
+    const void *newline{std::memchr(data.data() + offset, '\n', data.size() - offset)};
+    if (newline == nullptr) {
+        return data.size();
+    }
+    return findRecord(data, static_cast<std::size_t>(static_cast<const char *>(newline) - data.data()) + 1);
+}
+
+/**
+ * Time of day of a time on a file's timeline (which is negative before midnight of its first record, see Timeline).
+ */
+inline std::int64_t timeOfDay(std::int64_t time) {
+    return (time % millisecondsPerDay + millisecondsPerDay) % millisecondsPerDay;
+}
+
+/**
+ * Whole days to add to a time to get within 12 hours of a reference time (e.g. to continue a timeline, see Timeline).
+ */
+inline std::int64_t alignDays(std::int64_t time, std::int64_t reference) {
+    std::int64_t difference{reference - time + millisecondsPerDay / 2};
+    return difference - timeOfDay(difference);
+}
+
+/**
+ * Converts times of day of consecutive records to times since midnight of the first record's day.
+ *
+ * A time more than 12 hours before the latest one starts a new day. Records are only nearly ordered (threads race
+ * for the output), so a time more than 12 hours after the latest one still belongs to the previous day.
+ */
+class Timeline {
+public:
+    std::int64_t operator()(std::int64_t timeOfDay) {
+        if (m_latest >= 0 && timeOfDay + millisecondsPerDay / 2 < m_latest) {
+            ++m_day;
+        } else if (m_latest >= 0 && timeOfDay > m_latest + millisecondsPerDay / 2) {
+            return (m_day - 1) * millisecondsPerDay + timeOfDay;
+        }
+        m_latest = timeOfDay;
+        return m_day * millisecondsPerDay + timeOfDay;
+    }
+
+private:
+    std::int64_t m_day{0};
+    std::int64_t m_latest{-1};
+};
+
+/**
+ * Boundaries of chunks of about the given size starting at records (the first one is 0, the last one the data's size).
+ */
+inline std::vector<std::size_t> recordChunks(std::string_view data, std::size_t chunkSize) {
+    std::vector<std::size_t> boundaries{0};
+    for (std::size_t offset{chunkSize}; offset < data.size(); offset = boundaries.back() + chunkSize) {
+        std::size_t boundary{findRecord(data, offset)};
+        if (boundary >= data.size()) {
+            break;
+        }
+        boundaries.push_back(boundary);
+    }
+    boundaries.push_back(data.size());
+    return boundaries;
+}
+
+/**
+ * Process items on several threads and consume their results in order.
+ *
+ * Calls process(i, result) for each item, and consume(i, result) with the results in the order of the items on the
+ * calling thread. At most two items per thread are processed ahead of the consumed ones.
+ */
+template<typename Result, typename Process, typename Consume>
+void processInOrder(std::size_t count, unsigned threadCount, Process process, Consume consume) {
+    std::size_t window{std::min<std::size_t>(2 * std::max(1u, threadCount), count)};
+    std::vector<Result> results(window);
+    std::vector<char> done(window, false);
+    std::mutex mutex;
+    std::condition_variable itemDone;
+    std::condition_variable itemConsumed;
+    std::size_t consumed{0};
+    std::atomic<std::size_t> next{0};
+
+    auto work = [&]() {
+        for (std::size_t item{next++}; item < count; item = next++) {
+            Result result{};
+            process(item, result);
+            std::unique_lock lock{mutex};
+            itemConsumed.wait(lock, [&]() {
+                return item < consumed + window;
+            });
+            results[item % window] = std::move(result);
+            done[item % window] = true;
+            itemDone.notify_all();
+        }
+    };
+    std::vector<std::thread> threads;
+    for (unsigned t{0}; t < std::min<std::size_t>(threadCount, count); ++t) {
+        threads.emplace_back(work);
+    }
+    for (std::size_t item{0}; item < count; ++item) {
+        Result result;
+        {
+            std::unique_lock lock{mutex};
+            itemDone.wait(lock, [&]() {
+                return done[item % window];
+            });
+            result = std::move(results[item % window]);
+            done[item % window] = false;
+            ++consumed;
+        }
+        itemConsumed.notify_all();
+        consume(item, result);
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+}
+
+/**
+ * Process chunks of data on several threads and write their outputs in order.
+ *
+ * Calls process(begin, end, output) for each pair of consecutive boundaries, appending the chunk's output to the
+ * string. Returns false if writing failed.
+ */
+template<typename Process>
+bool processChunks(std::span<const std::size_t> boundaries, unsigned threadCount, Process process,
+        std::FILE *output) {
+    bool succeeded{true};
+    processInOrder<std::string>(boundaries.size() - 1, threadCount, [&](std::size_t chunk, std::string &result) {
+        process(boundaries[chunk], boundaries[chunk + 1], result);
+    }, [&](std::size_t, const std::string &result) {
+        succeeded = succeeded && std::fwrite(result.data(), 1, result.size(), output) == result.size();
+    });
+    return succeeded;
+}
+
+} // simple_logger::tools
@@ -0,0 +1,327 @@
+/**
+ * Filter records of log files by the fields of their prefix `[time][Level][file:line]` and by the message's text.
+ *
+ * Files are memory-mapped and split into chunks filtered in parallel. Lines are found by comparing 32 (AVX2) or 16
+ * (SSE2) bytes at once, and with a text to search, the whole chunk is searched for it first (memmem), so only records
+ * containing it are parsed.
+ *
+ * Usage: simple_logger_filter [--level LEVEL] [--file NAME] [--lines FIRST-LAST] [--from TIME] [--to TIME]
+ *                             [--grep TEXT] [--threads N] FILE...
+ *
+ * --level keeps records of the level and higher ones, --file compares the file name as printed in the prefix,
+ * --lines is a single line or an inclusive range (FIRST-LAST, or FIRST- for all lines from FIRST on), and --from/--to
+ * are times of day (HH:MM, HH:MM:SS or HH:MM:SS.mmm, TO is exclusive and before FROM over midnight).
+ */
+
+#include "log_file.h"
+
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+using namespace simple_logger::tools;
+
+namespace {
+
+/**
+ * Bit mask of the positions of a character in a block of bytes (as many bits as the vectors have bytes).
+ */
+#if defined(__AVX2__)
+constexpr std::size_t blockSize{32};
+
+inline std::uint32_t matchMask(const char *block, char character) {
+    __m256i bytes{_mm256_loadu_si256(reinterpret_cast<const __m256i *>(block))};
+    return static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(bytes, _mm256_set1_epi8(character))));
+}
+#elif defined(__SSE2__)
+constexpr std::size_t blockSize{16};
+
+inline std::uint32_t matchMask(const char *block, char character) {
+    __m128i bytes{_mm_loadu_si128(reinterpret_cast<const __m128i *>(block))};
+    return static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(character))));
+}
+#else
+constexpr std::size_t blockSize{8};
+
+inline std::uint32_t matchMask(const char *block, char character) {
+    std::uint32_t mask{0};
+    for (std::size_t i{0}; i < blockSize; ++i) {
+        mask |= static_cast<std::uint32_t>(block[i] == character) << i;
+    }
+    return mask;
+}
+#endif
+
+/**
+ * Position of the first occurrence of a character in [begin, end), end if there's none.
+ */
+const char *findCharacter(const char *begin, const char *end, char character) {
+    for (; begin + blockSize <= end; begin += blockSize) {
+        if (std::uint32_t mask{matchMask(begin, character)}; mask != 0) {
+            return begin + std::countr_zero(mask);
+        }
+    }
+    for (; begin < end && *begin != character; ++begin) {
+    }
+    return begin;
+}
+
+/**
+ * Fields of a record's prefix.
+ */
+struct Prefix {
+    std::int64_t timeOfDay;
+    // index of the level in levelNames
+    std::optional<std::size_t> level;
+    std::string_view file;
+    std::uint64_t line;
+    // the rest of the record after the prefix
+    std::string_view message;
+};
+
+std::optional<std::size_t> parseLevel(std::string_view name) {
+    auto level = std::find(levelNames.begin(), levelNames.end(), name);
+    return level != levelNames.end() ? std::optional(static_cast<std::size_t>(level - levelNames.begin()))
+                                     : std::nullopt;
+}
+
+/**
+ * Range of lines given on the command line (`N`, `FIRST-LAST` or `FIRST-` for all lines from FIRST on).
+ */
+std::optional<std::pair<std::uint64_t, std::uint64_t>> parseLines(std::string_view text) {
+    std::uint64_t first{0};
+    const char *end{text.data() + text.size()};
+    auto [firstEnd, firstError] = std::from_chars(text.data(), end, first);
+    if (firstError != std::errc{}) {
+        return std::nullopt;
+    }
+    if (firstEnd == end) {
+        return std::pair(first, first);
+    }
+    if (*firstEnd != '-') {
+        return std::nullopt;
+    }
+    if (firstEnd + 1 == end) {
+        return std::pair(first, std::numeric_limits<std::uint64_t>::max());
+    }
+    std::uint64_t last{0};
+    auto [lastEnd, lastError] = std::from_chars(firstEnd + 1, end, last);
+    if (lastError != std::errc{} || lastEnd != end || last < first) {
+        return std::nullopt;
+    }
+    return std::pair(first, last);
+}
+
+std::optional<Prefix> parsePrefix(std::string_view record) {
+    std::optional<std::int64_t> time{parsePrefixTime(record)};
+    // [HH:MM:SS.mmm][Level][file:line]
+    if (!time || record.size() < 15 || record[14] != '[') {
+        return std::nullopt;
+    }
+    const char *end{record.data() + record.size()};
+    const char *levelEnd{findCharacter(record.data() + 15, end, ']')};
+    if (levelEnd + 1 >= end || levelEnd[1] != '[') {
+        return std::nullopt;
+    }
+    const char *locationEnd{findCharacter(levelEnd + 2, end, ']')};
+    std::string_view location{levelEnd + 2, static_cast<std::size_t>(locationEnd - levelEnd - 2)};
+    std::size_t colon{location.rfind(':')};
+    if (locationEnd == end || colon == std::string_view::npos) {
+        return std::nullopt;
+    }
+    std::uint64_t line{0};
+    for (char digit : location.substr(colon + 1)) {
+        line = line * 10 + static_cast<std::uint64_t>(digit - '0');
+    }
+    return Prefix{*time, parseLevel({record.data() + 15, static_cast<std::size_t>(levelEnd - record.data() - 15)}),
+            location.substr(0, colon), line, {locationEnd + 1, static_cast<std::size_t>(end - locationEnd - 1)}};
+}
+
+struct Filter {
+    std::optional<std::size_t> level;
+    std::optional<std::string> file;
+    std::uint64_t firstLine{0};
+    std::uint64_t lastLine{std::numeric_limits<std::uint64_t>::max()};
+    std::int64_t from{0};
+    // length of the time range starting at from, a whole day if not restricted
+    std::int64_t length{millisecondsPerDay};
+    std::string text;
+
+    bool matches(std::string_view record) const {
+        std::optional<Prefix> prefix{parsePrefix(record)};
+        if (!prefix) {
+            return false;
+        }
+        return timeOfDay(prefix->timeOfDay - from) < length
+                && (!level || (prefix->level && *prefix->level >= *level))
+                && (!file || prefix->file == *file)
+                && prefix->line >= firstLine && prefix->line <= lastLine
+                && (text.empty() || prefix->message.find(text) != std::string_view::npos);
+    }
+};
+
+/**
+ * Call a function with each record starting in [begin, end) (which starts at a record), scanning for line ends a
+ * vector at a time.
+ */
+template<typename F>
+void forEachRecord(std::string_view data, std::size_t begin, std::size_t end, F function) {
+    const char *base{data.data()};
+    std::size_t recordBegin{begin};
+    auto lineStart = [&](std::size_t offset) {
+        if (offset >= end || parsePrefixTime(data.substr(offset, 14))) {
+            function(data.substr(recordBegin, offset - recordBegin));
+            recordBegin = offset;
+        }
+    };
+    std::size_t block{begin};
+    for (; block + blockSize <= end; block += blockSize) {
+        for (std::uint32_t mask{matchMask(base + block, '\n')}; mask != 0; mask &= mask - 1) {
+            lineStart(block + static_cast<std::size_t>(std::countr_zero(mask)) + 1);
+        }
+    }
+    for (; block < end; ++block) {
+        if (base[block] == '\n') {
+            lineStart(block + 1);
+        }
+    }
+    if (recordBegin < end) {
+        function(data.substr(recordBegin, end - recordBegin));
+    }
+}
+
+/**
+ * Start of the record containing the given offset (at or before the chunk's beginning, which starts a record).
+ */
+std::size_t recordContaining(std::string_view data, std::size_t begin, std::size_t offset) {
+    while (offset > begin) {
+        std::size_t newline{data.rfind('\n', offset - 1)};
+        std::size_t line{newline == std::string_view::npos ? 0 : newline + 1};
+        if (line <= begin || parsePrefixTime(data.substr(line, 14))) {
+            return std::max(line, begin);
+        }
+        offset = line - 1;
+    }
+    return begin;
+}
+
+void filterChunk(std::string_view data, std::size_t begin, std::size_t end, const Filter &filter,
+        std::string &output) {
+    auto keep = [&](std::string_view record) {
+        if (filter.matches(record)) {
+            output.append(record);
+        }
+    };
+    if (filter.text.empty()) {
+        forEachRecord(data, begin, end, keep);
+        return;
+    }
+    // only records containing the text can match, skip to them
+    std::size_t offset{begin};
+    while (offset < end) {
+        const void *found{::memmem(data.data() + offset, end - offset, filter.text.data(), filter.text.size())};
+        if (found == nullptr) {
+            break;
+        }
+        std::size_t record{recordContaining(data, begin, static_cast<std::size_t>(
+                static_cast<const char *>(found) - data.data()))};
+        std::size_t recordEnd{std::min(simple_logger::tools::recordEnd(data, record), end)};
+        keep(data.substr(record, recordEnd - record));
+        offset = recordEnd;
+    }
+}
+
+int usage() {
+    std::fprintf(stderr, "usage: simple_logger_filter [--level LEVEL] [--file NAME] [--lines FIRST-LAST] "
+            "[--from TIME] [--to TIME] [--grep TEXT] [--threads N] FILE...\n");
+    return 2;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    Filter filter;
+    std::optional<std::int64_t> from;
+    std::optional<std::int64_t> to;
+    unsigned threadCount{std::max(1u, std::thread::hardware_concurrency())};
+    std::vector<std::string> paths;
+    for (int i{1}; i < argc; ++i) {
+        std::string_view argument{argv[i]};
+        bool hasValue{i + 1 < argc};
+        if (argument == "--level" && hasValue) {
+            filter.level = parseLevel(argv[++i]);
+            if (!filter.level) {
+                return usage();
+            }
+        } else if (argument == "--file" && hasValue) {
+            filter.file = argv[++i];
+        } else if (argument == "--lines" && hasValue) {
+            auto lines = parseLines(argv[++i]);
+            if (!lines) {
+                return usage();
+            }
+            std::tie(filter.firstLine, filter.lastLine) = *lines;
+        } else if (argument == "--from" && hasValue) {
+            from = parseTimeOfDay(argv[++i]);
+            if (!from) {
+                return usage();
+            }
+        } else if (argument == "--to" && hasValue) {
+            to = parseTimeOfDay(argv[++i]);
+            if (!to) {
+                return usage();
+            }
+        } else if (argument == "--grep" && hasValue) {
+            filter.text = argv[++i];
+        } else if (argument == "--threads" && hasValue) {
+            threadCount = std::max(1ul, std::strtoul(argv[++i], nullptr, 10));
+        } else if (argument.starts_with("--")) {
+            return usage();
+        } else {
+            paths.emplace_back(argument);
+        }
+    }
+    if (paths.empty()) {
+        return usage();
+    }
+    if (from || to) {
+        filter.from = from.value_or(0);
+        filter.length = to ? timeOfDay(*to - filter.from) : millisecondsPerDay - filter.from;
+        if (to && filter.length == 0) {
+            filter.length = millisecondsPerDay;
+        }
+    }
+
+    static char outputBuffer[1 << 20];
+    std::setvbuf(stdout, outputBuffer, _IOFBF, sizeof(outputBuffer));
+    bool succeeded{true};
+    for (const auto &path : paths) {
+        try {
+            MappedFile file{path};
+            std::string_view data{file.view()};
+            std::vector<std::size_t> boundaries{recordChunks(data, std::size_t{8} << 20)};
+            succeeded = processChunks(boundaries, threadCount, [&](std::size_t begin, std::size_t end,
+                    std::string &output) {
+                filterChunk(data, begin, end, filter, output);
+            }, stdout) && succeeded;
+        } catch (const std::exception &exception) {
+            std::fprintf(stderr, "simple_logger_filter: %s\n", exception.what());
+            succeeded = false;
+        }
+    }
+    return succeeded && std::fflush(stdout) == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
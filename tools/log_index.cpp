@@ -0,0 +1,290 @@
+/**
+ * Sparse time index of log files, to print a time range without scanning the whole file.
+ *
+ * The index (stored next to the log file as FILE.idx) splits the file into blocks of about N KB starting at record
+ * boundaries and stores the offset and the earliest and latest time of each block. Files are memory-mapped, and both
+ * building an index and printing a time range use all threads: chunks of a file (or its blocks) are processed in
+ * parallel and combined in order.
+ *
+ * Usage:
+ *   simple_logger_index [--block-size KB] [--threads N] FILE...   build (or rebuild) the index of each file
+ *   simple_logger_index --query FROM TO FILE...                     print records with FROM <= time < TO
+ *
+ * FROM and TO are times of day (HH:MM, HH:MM:SS or HH:MM:SS.mmm), matched on each day the file spans (TO before FROM
+ * means a range over midnight, TO equal to FROM the whole day). Queries use the index, building it first if it's
+ * missing or outdated.
+ */
+
+#include "log_file.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+using namespace simple_logger::tools;
+
+namespace {
+
+constexpr char indexMagic[8]{'S', 'L', 'I', 'D', 'X', '0', '0', '1'};
+
+struct IndexHeader {
+    char magic[8];
+    // size and modification time of the indexed log file, the index is outdated if they differ
+    std::uint64_t fileSize;
+    std::int64_t modificationTime;
+    std::uint64_t blockSize;
+    std::uint64_t blockCount;
+};
+
+struct IndexBlock {
+    std::uint64_t offset;
+    // earliest and latest time of the block's records on the file's timeline (see Timeline)
+    std::int64_t minTime;
+    std::int64_t maxTime;
+};
+
+struct Index {
+    IndexHeader header{};
+    std::vector<IndexBlock> blocks;
+
+    bool matches(const MappedFile &file) const {
+        return header.fileSize == file.view().size() && header.modificationTime == file.modificationTime();
+    }
+};
+
+/**
+ * Blocks of a chunk of a file, with times on the chunk's own timeline (starting on the day of its first record).
+ */
+struct ChunkIndex {
+    std::vector<IndexBlock> blocks;
+    std::int64_t firstTime{0};
+    std::int64_t lastTime{0};
+};
+
+void indexChunk(std::string_view data, std::size_t begin, std::size_t end, std::uint64_t blockSize,
+        ChunkIndex &chunk) {
+    Timeline timeline;
+    IndexBlock *block{nullptr};
+    for (std::size_t offset{findRecord(data, begin)}; offset < end; offset = recordEnd(data, offset)) {
+        std::int64_t time{timeline(*parsePrefixTime(data.substr(offset, 14)))};
+        if (block == nullptr) {
+            chunk.firstTime = time;
+        }
+        if (block == nullptr || offset >= block->offset + blockSize) {
+            block = &chunk.blocks.emplace_back(IndexBlock{offset, time, time});
+        }
+        block->minTime = std::min(block->minTime, time);
+        block->maxTime = std::max(block->maxTime, time);
+        chunk.lastTime = time;
+    }
+}
+
+/**
+ * Index a file in chunks on several threads, continuing the timeline of each chunk from the previous one.
+ */
+Index buildIndex(const MappedFile &file, std::uint64_t blockSize, unsigned threadCount) {
+    std::string_view data{file.view()};
+    Index index;
+    std::copy(std::begin(indexMagic), std::end(indexMagic), index.header.magic);
+    index.header.fileSize = data.size();
+    index.header.modificationTime = file.modificationTime();
+    index.header.blockSize = blockSize;
+
+    std::vector<std::size_t> boundaries{recordChunks(data, std::max<std::size_t>(blockSize, std::size_t{8} << 20))};
+    std::optional<std::int64_t> lastTime;
+    processInOrder<ChunkIndex>(boundaries.size() - 1, threadCount, [&](std::size_t c, ChunkIndex &chunk) {
+        indexChunk(data, boundaries[c], boundaries[c + 1], blockSize, chunk);
+    }, [&](std::size_t, const ChunkIndex &chunk) {
+        if (chunk.blocks.empty()) {
+            return;
+        }
+        std::int64_t days{lastTime ? alignDays(chunk.firstTime, *lastTime) : 0};
+        for (IndexBlock block : chunk.blocks) {
+            block.minTime += days;
+            block.maxTime += days;
+            index.blocks.push_back(block);
+        }
+        lastTime = chunk.lastTime + days;
+    });
+    index.header.blockCount = index.blocks.size();
+    return index;
+}
+
+void writeIndex(const std::string &path, const Index &index) {
+    std::string temporaryPath{path + ".tmp"};
+    std::FILE *file{std::fopen(temporaryPath.c_str(), "wb")};
+    if (file == nullptr) {
+        throw std::system_error(errno, std::generic_category(), temporaryPath);
+    }
+    bool written{std::fwrite(&index.header, sizeof(index.header), 1, file) == 1
+            && std::fwrite(index.blocks.data(), sizeof(IndexBlock), index.blocks.size(), file) == index.blocks.size()};
+    if (std::fclose(file) != 0 || !written || std::rename(temporaryPath.c_str(), path.c_str()) != 0) {
+        int error{errno};
+        std::remove(temporaryPath.c_str());
+        throw std::system_error(error, std::generic_category(), path);
+    }
+}
+
+/**
+ * Read an index file, an empty optional if it doesn't exist or isn't valid.
+ */
+std::optional<Index> readIndex(const std::string &path) {
+    std::FILE *file{std::fopen(path.c_str(), "rb")};
+    if (file == nullptr) {
+        return std::nullopt;
+    }
+    Index index;
+    bool valid{std::fread(&index.header, sizeof(index.header), 1, file) == 1
+            && std::equal(std::begin(indexMagic), std::end(indexMagic), index.header.magic)
+            && index.header.blockCount <= index.header.fileSize};
+    if (valid) {
+        index.blocks.resize(index.header.blockCount);
+        valid = std::fread(index.blocks.data(), sizeof(IndexBlock), index.blocks.size(), file) == index.blocks.size();
+    }
+    std::fclose(file);
+    return valid ? std::optional(std::move(index)) : std::nullopt;
+}
+
+std::string indexPath(const std::string &logPath) {
+    return logPath + ".idx";
+}
+
+/**
+ * Run a function for each file, on the given number of threads (each file is processed by a single thread).
+ */
+template<typename F>
+bool forEachFile(const std::vector<std::string> &paths, unsigned threadCount, F function) {
+    std::atomic<std::size_t> next{0};
+    std::atomic<bool> succeeded{true};
+    auto work = [&]() {
+        for (std::size_t i{next++}; i < paths.size(); i = next++) {
+            try {
+                function(paths[i]);
+            } catch (const std::exception &exception) {
+                std::fprintf(stderr, "simple_logger_index: %s\n", exception.what());
+                succeeded = false;
+            }
+        }
+    };
+    std::vector<std::thread> threads;
+    for (unsigned t{1}; t < std::min<std::size_t>(threadCount, paths.size()); ++t) {
+        threads.emplace_back(work);
+    }
+    work();
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    return succeeded;
+}
+
+/**
+ * Print records of the file with from <= time of day < to, using its index (blocks are filtered in parallel).
+ */
+void query(const std::string &path, std::int64_t from, std::int64_t to, std::uint64_t blockSize,
+        unsigned threadCount) {
+    MappedFile file{path};
+    std::optional<Index> index{readIndex(indexPath(path))};
+    if (!index || !index->matches(file)) {
+        index = buildIndex(file, blockSize, threadCount);
+        writeIndex(indexPath(path), *index);
+    }
+    std::int64_t length{timeOfDay(to - from)};
+    if (length == 0) {
+        length = millisecondsPerDay;
+    }
+    auto inRange = [&](std::int64_t recordTimeOfDay) {
+        return timeOfDay(recordTimeOfDay - from) < length;
+    };
+    auto blockInRange = [&](const IndexBlock &block) {
+        // either the block's earliest record is in the range, or the range starts again before its latest one
+        std::int64_t position{timeOfDay(block.minTime - from)};
+        return position < length || block.minTime + (millisecondsPerDay - position) <= block.maxTime;
+    };
+
+    std::string_view data{file.view()};
+    std::vector<std::size_t> boundaries;
+    for (const IndexBlock &block : index->blocks) {
+        boundaries.push_back(block.offset);
+    }
+    boundaries.push_back(data.size());
+    bool written{processChunks(boundaries, threadCount, [&](std::size_t begin, std::size_t end, std::string &output) {
+        const IndexBlock &block{index->blocks[static_cast<std::size_t>(std::lower_bound(boundaries.begin(),
+                boundaries.end(), begin) - boundaries.begin())]};
+        if (!blockInRange(block)) {
+            return;
+        }
+        for (std::size_t offset{begin}; offset < end;) {
+            std::size_t next{std::min(recordEnd(data, offset), end)};
+            if (inRange(*parsePrefixTime(data.substr(offset, 14)))) {
+                output.append(data.substr(offset, next - offset));
+            }
+            offset = next;
+        }
+    }, stdout)};
+    if (!written) {
+        throw std::system_error(errno, std::generic_category(), "output");
+    }
+}
+
+int usage() {
+    std::fprintf(stderr, "usage: simple_logger_index [--block-size KB] [--threads N] FILE...\n"
+            "       simple_logger_index [--block-size KB] --query FROM TO FILE...\n");
+    return 2;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    std::uint64_t blockSize{64 * 1024};
+    unsigned threadCount{std::max(1u, std::thread::hardware_concurrency())};
+    std::optional<std::int64_t> from;
+    std::optional<std::int64_t> to;
+    bool isQuery{false};
+    std::vector<std::string> paths;
+    for (int i{1}; i < argc; ++i) {
+        std::string_view argument{argv[i]};
+        if (argument == "--block-size" && i + 1 < argc) {
+            blockSize = std::max(1ul, std::strtoul(argv[++i], nullptr, 10)) * 1024;
+        } else if (argument == "--threads" && i + 1 < argc) {
+            threadCount = std::max(1ul, std::strtoul(argv[++i], nullptr, 10));
+        } else if (argument == "--query" && i + 2 < argc) {
+            isQuery = true;
+            from = parseTimeOfDay(argv[++i]);
+            to = parseTimeOfDay(argv[++i]);
+            if (!from || !to) {
+                return usage();
+            }
+        } else if (argument.starts_with("--")) {
+            return usage();
+        } else {
+            paths.emplace_back(argument);
+        }
+    }
+    if (paths.empty()) {
+        return usage();
+    }
+
+    static char outputBuffer[1 << 20];
+    std::setvbuf(stdout, outputBuffer, _IOFBF, sizeof(outputBuffer));
+    bool succeeded;
+    if (isQuery) {
+        // one file at a time, to print the files' records in the given order
+        succeeded = forEachFile(paths, 1, [&](const std::string &path) {
+            query(path, *from, *to, blockSize, threadCount);
+        });
+    } else {
+        // files in parallel, each one split between the remaining threads
+        unsigned threadsPerFile{std::max<unsigned>(1, threadCount / static_cast<unsigned>(paths.size()))};
+        succeeded = forEachFile(paths, threadCount, [&](const std::string &path) {
+            MappedFile file{path};
+            writeIndex(indexPath(path), buildIndex(file, blockSize, threadsPerFile));
+        });
+    }
+    return succeeded && std::fflush(stdout) == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
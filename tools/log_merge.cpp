@@ -0,0 +1,154 @@
+/**
+ * Merge log files (e.g. of several processes, or per-thread files) into a single stream ordered by time.
+ *
+ * The files are memory-mapped and merged record by record (including continuation lines of multi-line records) using
+ * a heap of the files' next records, so each file must be ordered by time itself (as written by the logger).
+ * Records with equal times keep the order of the files on the command line.
+ *
+ * The prefix has no date, so each file's days are counted from its first record (see Timeline), and files are aligned
+ * on the day of the first file's first record (each file has to start within 12 hours of it).
+ *
+ * Usage: simple_logger_merge [-o OUTPUT] FILE...
+ */
+
+#include "log_file.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace simple_logger::tools;
+
+namespace {
+
+/**
+ * Next record of an input file.
+ */
+class Cursor {
+public:
+    Cursor(const std::string &path, std::size_t order) : m_file(path), m_order(order) {
+        advance(findRecord(m_file.view(), 0));
+    }
+
+    bool atEnd() const {
+        return m_begin >= m_file.view().size();
+    }
+
+    std::int64_t time() const {
+        return m_time;
+    }
+
+    std::string_view record() const {
+        return m_file.view().substr(m_begin, m_end - m_begin);
+    }
+
+    void next() {
+        advance(m_end);
+    }
+
+    /**
+     * Shift the file's days so that its current record is within 12 hours of the given time.
+     */
+    void alignTo(std::int64_t time) {
+        m_dayOffset = alignDays(m_time, time);
+        m_time += m_dayOffset;
+    }
+
+    /**
+     * Heap order: the earliest record first, equal times in the order of the files.
+     */
+    static bool later(const Cursor *a, const Cursor *b) {
+        return a->m_time != b->m_time ? a->m_time > b->m_time : a->m_order > b->m_order;
+    }
+
+private:
+    MappedFile m_file;
+    std::size_t m_order;
+    Timeline m_timeline;
+    std::int64_t m_dayOffset{0};
+    std::size_t m_begin{0};
+    std::size_t m_end{0};
+    std::int64_t m_time{0};
+
+    void advance(std::size_t offset) {
+        std::string_view data{m_file.view()};
+        m_begin = offset;
+        if (!atEnd()) {
+            m_end = recordEnd(data, offset);
+            m_time = m_timeline(*parsePrefixTime(data.substr(offset, 14))) + m_dayOffset;
+        }
+    }
+};
+
+int usage() {
+    std::fprintf(stderr, "usage: simple_logger_merge [-o OUTPUT] FILE...\n");
+    return 2;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    const char *outputPath{nullptr};
+    std::vector<std::string> paths;
+    for (int i{1}; i < argc; ++i) {
+        std::string_view argument{argv[i]};
+        if (argument == "-o" && i + 1 < argc) {
+            outputPath = argv[++i];
+        } else if (argument.starts_with("-") && argument.size() > 1) {
+            return usage();
+        } else {
+            paths.emplace_back(argument);
+        }
+    }
+    if (paths.empty()) {
+        return usage();
+    }
+
+    try {
+        std::vector<std::unique_ptr<Cursor>> cursors;
+        std::vector<Cursor *> heap;
+        for (const auto &path : paths) {
+            Cursor &cursor{*cursors.emplace_back(std::make_unique<Cursor>(path, cursors.size()))};
+            if (!cursor.atEnd()) {
+                if (!heap.empty()) {
+                    cursor.alignTo(heap.front()->time());
+                }
+                heap.push_back(&cursor);
+            }
+        }
+        std::make_heap(heap.begin(), heap.end(), Cursor::later);
+
+        std::FILE *output{outputPath != nullptr ? std::fopen(outputPath, "wb") : stdout};
+        if (output == nullptr) {
+            throw std::system_error(errno, std::generic_category(), outputPath);
+        }
+        auto buffer = std::make_unique<char[]>(std::size_t{4} << 20);
+        std::setvbuf(output, buffer.get(), _IOFBF, std::size_t{4} << 20);
+
+        while (!heap.empty()) {
+            std::pop_heap(heap.begin(), heap.end(), Cursor::later);
+            Cursor &cursor{*heap.back()};
+            std::string_view record{cursor.record()};
+            std::fwrite(record.data(), 1, record.size(), output);
+            cursor.next();
+            if (cursor.atEnd()) {
+                heap.pop_back();
+            } else {
+                std::push_heap(heap.begin(), heap.end(), Cursor::later);
+            }
+        }
+        bool written{!std::ferror(output)};
+        if (std::fclose(output) != 0 || !written) {
+            throw std::system_error(errno, std::generic_category(), outputPath != nullptr ? outputPath : "output");
+        }
+    } catch (const std::exception &exception) {
+        std::fprintf(stderr, "simple_logger_merge: %s\n", exception.what());
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}